@@ -0,0 +1,97 @@
+#include "http_body_sink.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace http {
+namespace {
+/**\brief maximum count of octets moved by one call of transfer, default
+ * capacity of pipe
+ */
+constexpr size_t transfer_chunk = 64 * 1024;
+
+bool write_all(int fd, const char *data, size_t size) noexcept {
+  while (size != 0) {
+    ssize_t written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+} // namespace
+
+body_sink::body_sink(int fd) noexcept
+    : fd_{fd}
+    , pipe_{-1, -1}
+    , piped_{0} {
+}
+
+body_sink::~body_sink() {
+  if (pipe_[0] != -1) {
+    close(pipe_[0]);
+    close(pipe_[1]);
+  }
+}
+
+bool body_sink::write(std::string_view data) noexcept {
+  return write_all(fd_, data.data(), data.size());
+}
+
+ssize_t body_sink::transfer(int socket, size_t count) noexcept {
+  count = std::min(count, transfer_chunk);
+#ifdef __linux__
+  if (pipe_[0] == -1 && pipe2(pipe_, O_CLOEXEC) != 0) {
+    pipe_[0] = pipe_[1] = -1;
+    return copy(socket, count);
+  }
+
+  constexpr unsigned flags = SPLICE_F_MOVE | SPLICE_F_MORE | SPLICE_F_NONBLOCK;
+  if (piped_ < count) { // octets left by previous call are part of count
+    ssize_t moved = splice(socket, NULL, pipe_[1], NULL, count - piped_, flags);
+    if (moved < 0 && errno == EINVAL && piped_ == 0) {
+      return copy(socket, count); // descriptors don't support splice
+    } else if (moved <= 0 && piped_ == 0) {
+      return moved;
+    } else if (moved > 0) {
+      piped_ += moved;
+    }
+  }
+
+  // not drained octets are kept in pipe, so they are not lost on EAGAIN
+  size_t drained = 0;
+  for (size_t left = std::min(piped_, count); drained != left;) {
+    ssize_t written = splice(pipe_[0], NULL, fd_, NULL, left - drained, flags);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    } else if (written < 0 && errno == EINVAL) {
+      // destination doesn't support splice
+      written = copy(pipe_[0], left - drained);
+    }
+    if (written <= 0) {
+      break;
+    }
+    drained += written;
+  }
+  piped_ -= drained;
+  return drained != 0 ? static_cast<ssize_t>(drained) : -1;
+#else
+  return copy(socket, count);
+#endif
+}
+
+ssize_t body_sink::copy(int source, size_t count) noexcept {
+  char    buf[16 * 1024];
+  ssize_t readed = read(source, buf, std::min(count, sizeof(buf)));
+  if (readed <= 0) {
+    return readed;
+  }
+  return write_all(fd_, buf, readed) ? readed : -1;
+}
+} // namespace http
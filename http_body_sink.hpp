@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <sys/types.h>
+
+namespace http {
+/**\brief destination of request body, which is written to file descriptor,
+ * so large body is never kept in memory. Octets, that are already read from
+ * socket, are written by write(2), and rest of body is moved from socket by
+ * splice(2) through pipe, so it is never copied to user space
+ * \note typical usage: after headers_done write body from parsed buffer, then
+ * while request_parser::body_left() is not 0 call transfer and pass moved
+ * count to request_parser::skip_body
+ */
+class body_sink {
+public:
+  /**\param fd file descriptor of destination, it is not closed by the sink
+   */
+  explicit body_sink(int fd) noexcept;
+  ~body_sink();
+
+  body_sink(const body_sink &)            = delete;
+  body_sink &operator=(const body_sink &) = delete;
+
+  /**\brief write octets, that are already in user space
+   * \return false on error, errno is set
+   */
+  bool write(std::string_view data) noexcept;
+
+  /**\brief move up to count octets from the socket to the destination.
+   * Octets, that are read from the socket, but not accepted by destination,
+   * are kept in the pipe and are written first by next call
+   * \return count of octets written to destination, 0 if socket is closed,
+   * or -1 on error, errno is set. errno is EAGAIN if socket has no data or
+   * destination can not accept data now
+   */
+  ssize_t transfer(int socket, size_t count) noexcept;
+
+private:
+  /**\brief copy through user space buffer, if splice is not supported for
+   * the descriptors
+   */
+  ssize_t copy(int source, size_t count) noexcept;
+
+  int    fd_;
+  /**\brief created at first transfer
+   */
+  int    pipe_[2];
+  /**\brief octets in the pipe, which are not written to destination yet
+   */
+  size_t piped_;
+};
+} // namespace http
@@ -0,0 +1,114 @@
+#include "http_coro.hpp"
+
+#ifdef __linux__
+#  include <cerrno>
+#  include <sys/epoll.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+
+namespace http {
+namespace {
+/**\brief maximum count of events, which are handled by one poll
+ */
+constexpr int max_events = 256;
+} // namespace
+
+event_loop::event_loop() noexcept
+    : fd_{epoll_create1(EPOLL_CLOEXEC)} {
+}
+
+event_loop::~event_loop() {
+  if (fd_ != -1) {
+    close(fd_);
+  }
+}
+
+bool event_loop::valid() const noexcept {
+  return fd_ != -1;
+}
+
+int event_loop::poll(int timeout) noexcept {
+  epoll_event events[max_events];
+  int         count = epoll_wait(fd_, events, max_events, timeout);
+  if (count < 0) {
+    return errno == EINTR ? 0 : -1;
+  }
+
+  int resumed = 0;
+  for (int i = 0; i < count; ++i) {
+    // operation lives in frame of suspended coroutine
+    socket_stream::read_op &op =
+        *static_cast<socket_stream::read_op *>(events[i].data.ptr);
+    if (op.try_read() == false && op.stream_.wait(op)) {
+      continue; // spurious wakeup
+    }
+    op.handle_.resume();
+    ++resumed;
+  }
+  return resumed;
+}
+
+socket_stream::read_op::read_op(socket_stream &stream,
+                                void          *buf,
+                                size_t         size) noexcept
+    : stream_{stream}
+    , buf_{buf}
+    , size_{size}
+    , result_{-1} {
+}
+
+bool socket_stream::read_op::await_ready() noexcept {
+  return try_read();
+}
+
+bool socket_stream::read_op::await_suspend(
+    std::coroutine_handle<> handle) noexcept {
+  handle_ = handle;
+  // if the socket can not be armed, then coroutine gets error at once
+  return stream_.wait(*this);
+}
+
+ptrdiff_t socket_stream::read_op::await_resume() noexcept {
+  return result_;
+}
+
+bool socket_stream::read_op::try_read() noexcept {
+  do {
+    result_ = recv(stream_.fd_, buf_, size_, 0);
+  } while (result_ < 0 && errno == EINTR);
+  return result_ >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+}
+
+socket_stream::socket_stream(event_loop &loop, int fd) noexcept
+    : loop_{loop}
+    , fd_{fd}
+    , registered_{false} {
+}
+
+socket_stream::~socket_stream() {
+  if (registered_) {
+    epoll_ctl(loop_.fd_, EPOLL_CTL_DEL, fd_, NULL);
+  }
+}
+
+socket_stream::read_op socket_stream::read_some(void  *buf,
+                                                size_t size) noexcept {
+  return read_op{*this, buf, size};
+}
+
+bool socket_stream::wait(read_op &op) noexcept {
+  epoll_event event{};
+  event.events   = EPOLLIN | EPOLLONESHOT;
+  event.data.ptr = &op;
+  if (epoll_ctl(loop_.fd_,
+                registered_ ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+                fd_,
+                &event) != 0) {
+    op.result_ = -1;
+    return false;
+  }
+  registered_ = true;
+  return true;
+}
+} // namespace http
+#endif
@@ -0,0 +1,453 @@
+#pragma once
+// coroutine interface of the parser, it requires c++20
+
+#include "http_request_parser.hpp"
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+namespace http {
+/**\brief lazy coroutine, it is started by co_await and resumes awaiting
+ * coroutine at its end without recursion (symmetric transfer)
+ * \note exceptions are not propagated, they terminate the program as in the
+ * rest of the parser, which is noexcept
+ */
+template <typename T = void>
+class task;
+
+namespace detail {
+template <typename T>
+struct task_result {
+  void return_value(T value) noexcept {
+    value_ = std::move(value);
+  }
+
+  T take() noexcept {
+    return std::move(value_);
+  }
+
+  T value_{};
+};
+
+template <>
+struct task_result<void> {
+  void return_void() noexcept {
+  }
+
+  void take() noexcept {
+  }
+};
+} // namespace detail
+
+template <typename T>
+class task {
+public:
+  struct promise_type;
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  /**\brief resumes awaiting coroutine, if there is such one
+   */
+  struct final_awaiter {
+    bool await_ready() noexcept {
+      return false;
+    }
+
+    std::coroutine_handle<> await_suspend(handle_type handle) noexcept {
+      std::coroutine_handle<> next = handle.promise().continuation;
+      return next ? next : std::noop_coroutine();
+    }
+
+    void await_resume() noexcept {
+    }
+  };
+
+  struct promise_type : detail::task_result<T> {
+    task get_return_object() noexcept {
+      return task{handle_type::from_promise(*this)};
+    }
+
+    std::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+
+    final_awaiter final_suspend() noexcept {
+      return {};
+    }
+
+    void unhandled_exception() noexcept {
+      std::terminate();
+    }
+
+    std::coroutine_handle<> continuation;
+  };
+
+  struct awaiter {
+    bool await_ready() noexcept {
+      return false;
+    }
+
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<> awaiting) noexcept {
+      handle.promise().continuation = awaiting;
+      return handle;
+    }
+
+    T await_resume() noexcept {
+      return handle.promise().take();
+    }
+
+    handle_type handle;
+  };
+
+  task(task &&other) noexcept
+      : handle_{std::exchange(other.handle_, nullptr)} {
+  }
+
+  task(const task &)            = delete;
+  task &operator=(const task &) = delete;
+  task &operator=(task &&)      = delete;
+
+  ~task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  awaiter operator co_await() && noexcept {
+    return awaiter{handle_};
+  }
+
+private:
+  explicit task(handle_type handle) noexcept
+      : handle_{handle} {
+  }
+
+  handle_type handle_;
+};
+
+/**\brief source of octets, which is read by coroutine. read_some returns
+ * awaitable, which result is count of read octets, 0 at end of stream or
+ * negative value on error
+ */
+template <typename Stream>
+concept byte_stream = requires(Stream &stream, void *buf, size_t size) {
+  { stream.read_some(buf, size).await_resume() }
+      -> std::convertible_to<ptrdiff_t>;
+};
+
+namespace detail {
+/**\brief coroutine, which frame is destroyed at its end
+ */
+struct detached {
+  struct promise_type {
+    detached get_return_object() noexcept {
+      return {};
+    }
+
+    std::suspend_never initial_suspend() noexcept {
+      return {};
+    }
+
+    std::suspend_never final_suspend() noexcept {
+      return {};
+    }
+
+    void return_void() noexcept {
+    }
+
+    void unhandled_exception() noexcept {
+      std::terminate();
+    }
+  };
+};
+
+inline detached run_detached(task<void> work) {
+  co_await std::move(work);
+}
+
+/**\brief stream has no end of message, so request without Content-Length
+ * and chunked Transfer-Encoding has no body
+ */
+template <typename Policy>
+struct stream_policy : Policy {
+  static constexpr bool body_to_end = false;
+};
+} // namespace detail
+
+/**\brief start the task, it runs until its first suspension, and then it is
+ * resumed by the stream it waits for. Frame of the task is released at its
+ * end
+ */
+inline void spawn(task<void> work) {
+  detail::run_detached(std::move(work));
+}
+
+/**\brief reader of requests from byte stream. Data is read directly to buffer
+ * of the reader and parsed in place, coroutine is suspended only when parser
+ * needs more octets, so it doesn't need its own stack
+ * \code
+ * while (co_await reader.next_request()) {
+ *   handle(reader.request());
+ *   for (std::string_view chunk = co_await reader.body_chunk();
+ *        chunk.empty() == false;
+ *        chunk = co_await reader.body_chunk()) {
+ *     consume(chunk);
+ *   }
+ * }
+ * \endcode
+ * \tparam Policy compile time options of the parser, body_to_end is ignored
+ */
+template <byte_stream Stream, typename Policy = default_policy>
+class basic_request_reader {
+public:
+  using parser_type = basic_request_parser<detail::stream_policy<Policy>>;
+  using status      = request_parser_base::status;
+
+  static constexpr size_t default_buffer_size = 16 * 1024;
+
+  /**\param stream must be valid while the reader is used
+   * \param buffer_size size of buffer for one read
+   */
+  explicit basic_request_reader(
+      Stream              &stream,
+      size_t               buffer_size    = default_buffer_size,
+      size_t               spill_capacity = request_parser_base::
+          default_spill_capacity,
+      const parser_limits &limits         = parser_limits{});
+
+  /**\brief skip rest of body of current request and parse headers of next one
+   * \return false if stream is closed or request is invalid, in that case
+   * last_error tells the reason (none if stream is closed between requests)
+   * \note fields of request are valid until next call, they point to buffer
+   * of the reader or to spill of the parser
+   */
+  task<bool> next_request();
+
+  /**\return next part of body of current request, which is valid until next
+   * call, or empty view at end of body or on error
+   */
+  task<std::string_view> body_chunk();
+
+  const request_view &request() const noexcept;
+
+  /**\return reason of last error, bad_request if stream is closed inside
+   * request
+   */
+  parse_error last_error() const noexcept;
+
+private:
+  /**\brief parse buffered octets
+   */
+  status parse() noexcept;
+
+  /**\brief read next octets to the buffer, which must be parsed completely
+   * \return false if stream is closed
+   */
+  bool fill(ptrdiff_t size) noexcept;
+
+  Stream                 &stream_;
+  std::unique_ptr<char[]> buffer_;
+  size_t                  capacity_;
+  size_t                  begin_;
+  size_t                  end_;
+  parser_type             parser_;
+  request_view            req_;
+  /**\brief part of body, which is not returned by body_chunk yet
+   */
+  std::string_view body_;
+  bool             complete_;
+  parse_error      error_;
+};
+
+template <byte_stream Stream>
+using request_reader = basic_request_reader<Stream, default_policy>;
+
+template <byte_stream Stream, typename Policy>
+basic_request_reader<Stream, Policy>::basic_request_reader(
+    Stream              &stream,
+    size_t               buffer_size,
+    size_t               spill_capacity,
+    const parser_limits &limits)
+    : stream_{stream}
+    , buffer_{new char[buffer_size]}
+    , capacity_{buffer_size}
+    , begin_{0}
+    , end_{0}
+    , parser_{spill_capacity, limits}
+    , complete_{true}
+    , error_{parse_error::none} {
+}
+
+template <byte_stream Stream, typename Policy>
+task<bool> basic_request_reader<Stream, Policy>::next_request() {
+  while (complete_ == false && error_ == parse_error::none) {
+    co_await body_chunk();
+  }
+  body_ = std::string_view{};
+  if (error_ != parse_error::none) {
+    co_return false;
+  }
+
+  for (;;) {
+    if (begin_ == end_) {
+      ptrdiff_t size = co_await stream_.read_some(buffer_.get(), capacity_);
+      if (fill(size) == false) {
+        if (parser_.idle() == false) {
+          error_ = parse_error::bad_request; // closed inside request line
+        }
+        co_return false;
+      }
+    }
+
+    status res = parse();
+    if (res == status::error) {
+      co_return false;
+    } else if (res & status::headers_done) {
+      co_return true;
+    }
+  }
+}
+
+template <byte_stream Stream, typename Policy>
+task<std::string_view> basic_request_reader<Stream, Policy>::body_chunk() {
+  while (body_.empty()) {
+    if (complete_ || error_ != parse_error::none) {
+      co_return std::string_view{};
+    } else if (begin_ == end_) {
+      ptrdiff_t size = co_await stream_.read_some(buffer_.get(), capacity_);
+      if (fill(size) == false) {
+        error_ = parse_error::bad_request; // closed inside body
+        co_return std::string_view{};
+      }
+    }
+    parse();
+  }
+  co_return std::exchange(body_, std::string_view{});
+}
+
+template <byte_stream Stream, typename Policy>
+const request_view &
+basic_request_reader<Stream, Policy>::request() const noexcept {
+  return req_;
+}
+
+template <byte_stream Stream, typename Policy>
+parse_error basic_request_reader<Stream, Policy>::last_error() const noexcept {
+  return error_;
+}
+
+template <byte_stream Stream, typename Policy>
+request_parser_base::status
+basic_request_reader<Stream, Policy>::parse() noexcept {
+  size_t parsed = 0;
+  status res    = parser_.parse(
+      buffer_.get() + begin_, end_ - begin_, req_, &parsed);
+  begin_ += parsed;
+  if (res == status::error) {
+    error_    = parser_.last_error();
+    complete_ = true;
+    return res;
+  }
+  // fields of incomplete request are saved by the parser, so buffer can be
+  // reused by next read
+  body_     = req_.body;
+  complete_ = res == status::done;
+  return res;
+}
+
+template <byte_stream Stream, typename Policy>
+bool basic_request_reader<Stream, Policy>::fill(ptrdiff_t size) noexcept {
+  if (size <= 0) {
+    return false;
+  }
+  begin_ = 0;
+  end_   = static_cast<size_t>(size);
+  return true;
+}
+
+#ifdef __linux__
+class socket_stream;
+
+/**\brief event loop of sockets, which are read by coroutines, on epoll.
+ * Every socket is registered once and is rearmed (EPOLLONESHOT) only while
+ * its coroutine waits for data
+ */
+class event_loop {
+  friend socket_stream;
+
+public:
+  event_loop() noexcept;
+  ~event_loop();
+
+  event_loop(const event_loop &)            = delete;
+  event_loop &operator=(const event_loop &) = delete;
+
+  bool valid() const noexcept;
+
+  /**\brief wait for readable sockets and resume their coroutines
+   * \param timeout milliseconds, -1 to wait infinitely
+   * \return count of resumed coroutines, or -1 on error, errno is set
+   */
+  int poll(int timeout) noexcept;
+
+private:
+  int fd_;
+};
+
+/**\brief byte stream of non blocking socket, the socket is not owned
+ */
+class socket_stream {
+  friend event_loop;
+
+public:
+  /**\brief awaitable of read_some, data is read at once if it is available,
+   * otherwise coroutine is suspended until the socket is readable
+   */
+  class read_op {
+    friend event_loop;
+    friend socket_stream;
+
+  public:
+    read_op(socket_stream &stream, void *buf, size_t size) noexcept;
+
+    bool      await_ready() noexcept;
+    bool      await_suspend(std::coroutine_handle<> handle) noexcept;
+    ptrdiff_t await_resume() noexcept;
+
+  private:
+    /**\return false if there is no data yet
+     */
+    bool try_read() noexcept;
+
+    socket_stream          &stream_;
+    void                   *buf_;
+    size_t                  size_;
+    ptrdiff_t               result_;
+    std::coroutine_handle<> handle_;
+  };
+
+  socket_stream(event_loop &loop, int fd) noexcept;
+  ~socket_stream();
+
+  socket_stream(const socket_stream &)            = delete;
+  socket_stream &operator=(const socket_stream &) = delete;
+
+  read_op read_some(void *buf, size_t size) noexcept;
+
+private:
+  /**\brief arm the socket for one readiness event
+   */
+  bool wait(read_op &op) noexcept;
+
+  event_loop &loop_;
+  int         fd_;
+  bool        registered_;
+};
+
+static_assert(byte_stream<socket_stream>);
+#endif
+} // namespace http
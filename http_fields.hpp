@@ -0,0 +1,242 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace http {
+/**\brief well known header names
+ */
+enum class field : unsigned char {
+  unknown,
+  accept,
+  accept_charset,
+  accept_encoding,
+  accept_language,
+  accept_ranges,
+  access_control_request_headers,
+  access_control_request_method,
+  age,
+  authorization,
+  cache_control,
+  connection,
+  content_disposition,
+  content_encoding,
+  content_language,
+  content_length,
+  content_location,
+  content_range,
+  content_type,
+  cookie,
+  date,
+  dnt,
+  etag,
+  expect,
+  expires,
+  forwarded,
+  from,
+  host,
+  if_match,
+  if_modified_since,
+  if_none_match,
+  if_range,
+  if_unmodified_since,
+  keep_alive,
+  last_modified,
+  location,
+  origin,
+  pragma,
+  proxy_authenticate,
+  proxy_authorization,
+  proxy_connection,
+  range,
+  referer,
+  retry_after,
+  sec_websocket_key,
+  sec_websocket_protocol,
+  sec_websocket_version,
+  server,
+  set_cookie,
+  te,
+  trailer,
+  transfer_encoding,
+  upgrade,
+  upgrade_insecure_requests,
+  user_agent,
+  vary,
+  via,
+  www_authenticate,
+  x_forwarded_for,
+  x_forwarded_host,
+  x_forwarded_proto,
+  x_real_ip,
+  x_request_id,
+  count,
+};
+
+constexpr size_t field_count = static_cast<size_t>(field::count);
+
+namespace detail {
+constexpr std::string_view field_names[field_count] = {
+    "",
+    "Accept",
+    "Accept-Charset",
+    "Accept-Encoding",
+    "Accept-Language",
+    "Accept-Ranges",
+    "Access-Control-Request-Headers",
+    "Access-Control-Request-Method",
+    "Age",
+    "Authorization",
+    "Cache-Control",
+    "Connection",
+    "Content-Disposition",
+    "Content-Encoding",
+    "Content-Language",
+    "Content-Length",
+    "Content-Location",
+    "Content-Range",
+    "Content-Type",
+    "Cookie",
+    "Date",
+    "DNT",
+    "ETag",
+    "Expect",
+    "Expires",
+    "Forwarded",
+    "From",
+    "Host",
+    "If-Match",
+    "If-Modified-Since",
+    "If-None-Match",
+    "If-Range",
+    "If-Unmodified-Since",
+    "Keep-Alive",
+    "Last-Modified",
+    "Location",
+    "Origin",
+    "Pragma",
+    "Proxy-Authenticate",
+    "Proxy-Authorization",
+    "Proxy-Connection",
+    "Range",
+    "Referer",
+    "Retry-After",
+    "Sec-WebSocket-Key",
+    "Sec-WebSocket-Protocol",
+    "Sec-WebSocket-Version",
+    "Server",
+    "Set-Cookie",
+    "TE",
+    "Trailer",
+    "Transfer-Encoding",
+    "Upgrade",
+    "Upgrade-Insecure-Requests",
+    "User-Agent",
+    "Vary",
+    "Via",
+    "WWW-Authenticate",
+    "X-Forwarded-For",
+    "X-Forwarded-Host",
+    "X-Forwarded-Proto",
+    "X-Real-IP",
+    "X-Request-ID",
+};
+
+constexpr size_t field_table_bits = 9;
+constexpr size_t field_table_size = 1 << field_table_bits;
+
+constexpr char to_lower(char ch) noexcept {
+  return (ch >= 'A' && ch <= 'Z') ? ch | 0x20 : ch;
+}
+
+/**\brief hash by length and three octets of name, so it is very cheap, and
+ * seed is selected at compile time, so the hash is perfect for known names
+ */
+constexpr size_t field_hash(std::string_view name, uint32_t seed) noexcept {
+  const char octets[] = {name.front(), name[name.size() / 2], name.back()};
+
+  uint32_t hash = seed ^ static_cast<uint32_t>(name.size());
+  for (char ch : octets) {
+    hash = hash * 31 + static_cast<unsigned char>(to_lower(ch));
+  }
+  return (hash * 0x9e3779b1u) >> (32 - field_table_bits);
+}
+
+constexpr bool is_perfect_seed(uint32_t seed) noexcept {
+  bool used[field_table_size] = {};
+  for (size_t i = 1; i < field_count; ++i) {
+    size_t hash = field_hash(field_names[i], seed);
+    if (used[hash]) {
+      return false;
+    }
+    used[hash] = true;
+  }
+  return true;
+}
+
+constexpr uint32_t find_perfect_seed() noexcept {
+  uint32_t seed = 1;
+  while (is_perfect_seed(seed) == false) {
+    ++seed;
+  }
+  return seed;
+}
+
+constexpr uint32_t field_seed = find_perfect_seed();
+
+struct field_table {
+  constexpr field_table() noexcept
+      : slots{} {
+    for (size_t i = 1; i < field_count; ++i) {
+      slots[field_hash(field_names[i], field_seed)] = static_cast<field>(i);
+    }
+  }
+
+  field slots[field_table_size];
+};
+
+constexpr field_table field_slots;
+
+constexpr bool iequals(std::string_view lhs, std::string_view rhs) noexcept {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    if (to_lower(lhs[i]) != to_lower(rhs[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace detail
+
+/**\return known field for the header name (case insensetive), or
+ * field::unknown
+ */
+constexpr field to_field(std::string_view name) noexcept {
+  if (name.empty()) {
+    return field::unknown;
+  }
+
+  field candidate =
+      detail::field_slots.slots[detail::field_hash(name, detail::field_seed)];
+  if (candidate != field::unknown &&
+      detail::iequals(name,
+                      detail::field_names[static_cast<size_t>(candidate)])) {
+    return candidate;
+  }
+  return field::unknown;
+}
+
+/**\return canonical name of the field, or empty view for field::unknown
+ */
+constexpr std::string_view to_string(field id) noexcept {
+  return detail::field_names[static_cast<size_t>(id)];
+}
+
+static_assert(to_field("content-length") == field::content_length,
+              "invalid perfect hash for header names");
+static_assert(to_field("X-Unknown") == field::unknown,
+              "invalid perfect hash for header names");
+} // namespace http
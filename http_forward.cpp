@@ -0,0 +1,257 @@
+#include "http_forward.hpp"
+#include <cstdint>
+
+namespace http {
+namespace {
+/**\brief maximum count of octets between tokens, which are taken from the
+ * buffer as they were received
+ */
+constexpr size_t max_gap = 16;
+
+/**\brief iovecs of forwarded request, span that follows previous one in
+ * memory extends it
+ */
+class iov_list {
+public:
+  iov_list(iovec *iov, size_t capacity) noexcept
+      : iov_{iov}
+      , count_{0}
+      , capacity_{capacity}
+      , full_{false} {
+  }
+
+  void push(std::string_view span) noexcept {
+    if (span.empty()) {
+      return;
+    } else if (count_ != 0) {
+      iovec &last = iov_[count_ - 1];
+      if (static_cast<const char *>(last.iov_base) + last.iov_len ==
+          span.data()) {
+        last.iov_len += span.size();
+        return;
+      }
+    }
+
+    if (count_ == capacity_) {
+      full_ = true;
+      return;
+    }
+    iov_[count_].iov_base = const_cast<char *>(span.data());
+    iov_[count_].iov_len  = span.size();
+    ++count_;
+  }
+
+  /**\return count of iovecs, or 0 if they are not fit to capacity
+   */
+  size_t size() const noexcept {
+    return full_ ? 0 : count_;
+  }
+
+private:
+  iovec *iov_;
+  size_t count_;
+  size_t capacity_;
+  bool   full_;
+};
+
+/**\return octets between end of token and next token, if both of them are in
+ * the buffer and the next one follows soon after the end. Tokens can be saved
+ * in spill of the parser, so their pointers are compared as offsets in the
+ * buffer, because relational operators are not defined for different objects
+ */
+std::string_view
+gap(std::string_view buffer, const char *end, const char *next) noexcept {
+  uintptr_t base   = reinterpret_cast<uintptr_t>(buffer.data());
+  uintptr_t first  = reinterpret_cast<uintptr_t>(end) - base;
+  uintptr_t second = reinterpret_cast<uintptr_t>(next) - base;
+  if (first >= second || second > buffer.size() || second - first > max_gap) {
+    return std::string_view{};
+  }
+  return std::string_view{end, second - first};
+}
+
+/**\return separator of method and target as it was received, or canonical
+ * one
+ */
+std::string_view space(std::string_view buffer,
+                       std::string_view method,
+                       std::string_view target) noexcept {
+  std::string_view retval =
+      gap(buffer, method.data() + method.size(), target.data());
+  return retval == " " ? retval : " ";
+}
+
+/**\return count of spaces and tabs at start of the view
+ */
+size_t blanks(std::string_view view) noexcept {
+  size_t retval = 0;
+  for (char ch : view) {
+    if (ch != ' ' && ch != '\t') {
+      break;
+    }
+    ++retval;
+  }
+  return retval;
+}
+
+/**\return separator of header name and value as it was received, or
+ * canonical one
+ */
+std::string_view colon(std::string_view    buffer,
+                       const header_field &header) noexcept {
+  std::string_view retval = gap(
+      buffer, header.name.data() + header.name.size(), header.value.data());
+  if (retval.empty() || retval[0] != ':' ||
+      blanks(retval.substr(1)) + 1 != retval.size()) {
+    return ": ";
+  }
+  return retval;
+}
+
+/**\return end of header line as it was received (with trailing whitespaces of
+ * value), or canonical one
+ * \param next name of next received header, or body after last header
+ */
+std::string_view line_end(std::string_view buffer,
+                          std::string_view value,
+                          const char      *next) noexcept {
+  std::string_view retval = gap(buffer, value.data() + value.size(), next);
+  size_t           crlf   = blanks(retval);
+  if (retval.size() - crlf < 2 || retval[crlf] != '\r' ||
+      retval[crlf + 1] != '\n') {
+    return "\r\n";
+  }
+  return retval.substr(0, crlf + 2);
+}
+} // namespace
+
+forward_serializer::forward_serializer(size_t capacity) noexcept
+    : edits_count_{0}
+    , side_{capacity} {
+}
+
+bool forward_serializer::remove(std::string_view name) noexcept {
+  if (edits_count_ == max_edits) {
+    return false;
+  }
+  edits_[edits_count_++] = edit{name, std::string_view{}, true};
+  return true;
+}
+
+bool forward_serializer::add(std::string_view name,
+                             std::string_view value) noexcept {
+  if (edits_count_ == max_edits) {
+    return false;
+  }
+  edits_[edits_count_++] = edit{name, value, false};
+  return true;
+}
+
+bool forward_serializer::set(std::string_view name,
+                             std::string_view value) noexcept {
+  if (edits_count_ + 2 > max_edits) {
+    return false;
+  }
+  return remove(name) && add(name, value);
+}
+
+void forward_serializer::clear() noexcept {
+  edits_count_ = 0;
+}
+
+size_t forward_serializer::serialize(const request_view &req,
+                                     std::string_view    buffer,
+                                     iovec              *iov,
+                                     size_t              count) noexcept {
+  if (req.major < 0 || req.major > 9 || req.minor < 0 || req.minor > 9) {
+    return 0;
+  }
+  side_.clear();
+  iov_list out{iov, count};
+
+  out.push(req.method);
+  out.push(space(buffer, req.method, req.target));
+  out.push(req.target);
+
+  // version is not kept by request_view as text, so it is taken from the
+  // buffer only if it is same as canonical one
+  const char *first = req.headers_count != 0 ? req.headers[0].name.data()
+                                             : nullptr;
+  char version[] = " HTTP/x.y\r\n";
+  version[6]     = static_cast<char>('0' + req.major);
+  version[8]     = static_cast<char>('0' + req.minor);
+  std::string_view tail{version, sizeof(version) - 1};
+  std::string_view received =
+      gap(buffer, req.target.data() + req.target.size(), first);
+  if (received == tail) {
+    tail = received;
+  } else if (side_.save(tail) == false) {
+    return 0;
+  }
+  out.push(tail);
+
+  // absolute form target is reported by the parser as origin form and Host
+  // header with its authority, which is before received Host
+  bool host = false;
+  for (size_t i = 0; i < req.headers_count; ++i) {
+    const header_field &header  = req.headers[i];
+    bool                is_host = detail::iequals(header.name, "host");
+    if ((is_host && host) || removed(header.name)) {
+      continue;
+    }
+    host = host || is_host;
+
+    const char *next = req.chunked ? nullptr : req.body.data();
+    if (i + 1 < req.headers_count) {
+      next = req.headers[i + 1].name.data();
+    }
+    out.push(header.name);
+    out.push(colon(buffer, header));
+    out.push(header.value);
+    out.push(line_end(buffer, header.value, next));
+  }
+
+  for (size_t i = 0; i < edits_count_; ++i) {
+    std::string_view added;
+    if (edits_[i].remove) {
+      continue;
+    } else if (line(edits_[i].name, edits_[i].value, added) == false) {
+      return 0;
+    }
+    out.push(added);
+  }
+
+  std::string_view end = "\r\n";
+  if (side_.save(end) == false) {
+    return 0;
+  }
+  out.push(end);
+
+  if (req.chunked == false) {
+    out.push(req.body);
+  }
+  return out.size();
+}
+
+bool forward_serializer::removed(std::string_view name) const noexcept {
+  for (size_t i = 0; i < edits_count_; ++i) {
+    // names are compared only if their sizes are same
+    if (edits_[i].remove && detail::iequals(edits_[i].name, name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool forward_serializer::line(std::string_view  name,
+                              std::string_view  value,
+                              std::string_view &out) noexcept {
+  out = name;
+  if (side_.save(out) == false || side_.extend(out, ": ") == false) {
+    return false;
+  } else if (value.empty() == false && side_.extend(out, value) == false) {
+    return false;
+  }
+  return side_.extend(out, "\r\n");
+}
+} // namespace http
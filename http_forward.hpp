@@ -0,0 +1,83 @@
+#pragma once
+
+#include "http_request_parser.hpp"
+#include <cstddef>
+#include <string_view>
+#include <sys/uio.h>
+
+namespace http {
+/**\brief serializer of parsed request for forwarding to upstream by
+ * writev(2) or sendmsg(2). Request is not rebuilt: request line, untouched
+ * headers and body point to the buffer, where request was parsed (or to spill
+ * of the parser), adjacent spans are merged into one iovec. Only removed,
+ * replaced or added headers and rewritten request line are changed, new
+ * octets are written to small side buffer. Absolute form target is split by
+ * the parser to origin form and Host header with authority, only first Host
+ * header is forwarded, so request line and Host are rewritten as upstream
+ * expects from proxy
+ * \note names and values of edits are not copied, they must be valid until
+ * serialize is called. Edits are kept for next requests, until clear
+ * \note body of chunked request is not written, because request_view holds
+ * only last chunk, chunks must be forwarded with their framing by caller.
+ * CONNECT request is not forwarded, it starts a tunnel
+ */
+class forward_serializer {
+public:
+  static constexpr size_t max_edits        = 16;
+  static constexpr size_t default_capacity = 1024;
+
+  /**\param capacity size of side buffer for new octets, it is allocated at
+   * first use
+   */
+  explicit forward_serializer(size_t capacity = default_capacity) noexcept;
+
+  /**\brief don't forward headers with the name (case insensetive)
+   * \return false if there are max_edits edits already
+   */
+  bool remove(std::string_view name) noexcept;
+
+  /**\brief add header after all forwarded headers of request
+   */
+  bool add(std::string_view name, std::string_view value) noexcept;
+
+  /**\brief replace all headers with the name by one header
+   */
+  bool set(std::string_view name, std::string_view value) noexcept;
+
+  /**\brief remove all edits
+   */
+  void clear() noexcept;
+
+  /**\brief fill iov by spans of forwarded request, previous iovecs are
+   * invalidated, because side buffer is reused
+   * \param buffer last buffer, which was parsed to the request. Separators of
+   * fields are taken as they were received only if both fields are in it,
+   * fields saved by the parser are separated by canonical ones
+   * \return count of filled iovecs, or 0 if count is not enough or side buffer
+   * is full
+   */
+  size_t serialize(const request_view &req,
+                   std::string_view    buffer,
+                   iovec              *iov,
+                   size_t              count) noexcept;
+
+private:
+  struct edit {
+    std::string_view name;
+    std::string_view value;
+    bool             remove;
+  };
+
+  bool removed(std::string_view name) const noexcept;
+
+  /**\brief save "name: value\r\n" to side buffer
+   */
+  bool line(std::string_view  name,
+            std::string_view  value,
+            std::string_view &out) noexcept;
+
+  edit         edits_[max_edits];
+  size_t       edits_count_;
+  spill_buffer side_;
+};
+} // namespace http
@@ -1,413 +1,546 @@
 #include "http_request_parser.hpp"
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <new>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
-#define HTTP           "HTTP"
-#define CONNECTION     "Connection"
-#define CONTENT_LENGTH "Content-Length"
-#define KEEP_ALIVE     "Keep-Alive"
-#define HOST           "Host"
-
-#define IS_UPALPHA(ch) ((ch) >= 'A' && (ch) <= 'Z')
-#define IS_LOALPHA(ch) ((ch) >= 'a' && (ch) <= 'z')
-#define IS_ALPHA(ch)   (IS_UPALPHA(ch) || IS_LOALPHA(ch))
-#define IS_DIGIT(ch)   ((ch) >= '0' && (ch) <= '9')
-#define IS_CTL(ch)     (((ch) > 0 && (ch) < 31 && (ch) != '\t') || (ch) == 127)
-#define IS_VCHAR(ch)   ((ch) >= 33 && (ch) <= 126)
-#define CR             '\r'
-#define LF             '\n'
-#define CRLF           "\r\n"
-#define SP             ' '
-#define HT             '\t'
-#define SLASH          '/'
-#define COLON          ':'
-#define ASTERISK       '*'
-
-#define DOT '.'
-
-#define IS_TEXT(ch) (IS_CTL(ch) == false || (ch) == LF || (ch) == CR)
-#define IS_HEX(ch) \
-  (IS_DIGIT(ch) || ((ch) >= 'A' && (ch) <= 'F') || ((ch) >= 'a' && (ch) <= 'f'))
-
-#define IS_SEPARATOR(ch) (strchr(", /;:=()<>@\"[]?{}\t\\", ch))
-#define IS_SPACE(ch)     ((ch) == ' ' || (ch) == '\t')
+static_assert(http::message_view::max_headers < 256,
+              "index of header must be stored in unsigned char");
 
 namespace http {
 std::size_t
-string_case_insensetive_hash::operator()(std::string str) const noexcept {
-  for (char &ch : str) {
-    ch = tolower(ch);
+string_case_insensetive_hash::operator()(std::string_view str) const noexcept {
+  field id = to_field(str);
+  if (id != field::unknown) {
+    return static_cast<std::size_t>(id);
   }
-  return std::hash<std::string>()(str);
+
+  // FNV-1a
+  std::size_t retval = 14695981039346656037ull;
+  for (char ch : str) {
+    retval ^= static_cast<unsigned char>(detail::to_lower(ch));
+    retval *= 1099511628211ull;
+  }
+  return retval;
 }
 
 bool string_case_insensetive_comp::operator()(
-    const std::string &lhs,
-    const std::string &rhs) const noexcept {
-  if (lhs.size() != rhs.size()) {
-    return false;
+    std::string_view lhs,
+    std::string_view rhs) const noexcept {
+  return detail::iequals(lhs, rhs);
+}
+
+
+flat_headers::flat_headers(const allocator_type &alloc)
+    : entries_{alloc}
+    , fields_{alloc} {
+}
+
+flat_headers::iterator flat_headers::begin() noexcept {
+  return entries_.begin();
+}
+
+flat_headers::iterator flat_headers::end() noexcept {
+  return entries_.end();
+}
+
+flat_headers::const_iterator flat_headers::begin() const noexcept {
+  return entries_.begin();
+}
+
+flat_headers::const_iterator flat_headers::end() const noexcept {
+  return entries_.end();
+}
+
+size_t flat_headers::size() const noexcept {
+  return entries_.size();
+}
+
+bool flat_headers::empty() const noexcept {
+  return entries_.empty();
+}
+
+void flat_headers::clear() noexcept {
+  entries_.clear();
+  fields_.clear();
+}
+
+void flat_headers::reserve(size_t capacity) {
+  entries_.reserve(capacity);
+  fields_.reserve(capacity);
+}
+
+flat_headers::iterator flat_headers::find(std::string_view name) noexcept {
+  return entries_.begin() + index_of(name);
+}
+
+flat_headers::const_iterator
+flat_headers::find(std::string_view name) const noexcept {
+  return entries_.begin() + index_of(name);
+}
+
+size_t flat_headers::count(std::string_view name) const noexcept {
+  return index_of(name) == entries_.size() ? 0 : 1;
+}
+
+std::string &flat_headers::operator[](std::string_view name) {
+  return emplace(name, std::string_view{}).first->second;
+}
+
+std::pair<flat_headers::iterator, bool>
+flat_headers::emplace(std::string_view name, std::string_view value) {
+  size_t index = index_of(name);
+  if (index != entries_.size()) {
+    return {entries_.begin() + index, false};
+  }
+
+  if (entries_.capacity() == 0) {
+    reserve(default_capacity);
   }
+  entries_.emplace_back(std::string{name}, std::string{value});
+  fields_.push_back(to_field(name));
+  return {entries_.end() - 1, true};
+}
 
-  for (size_t i = 0; i < lhs.size(); ++i) {
-    if (tolower(lhs[i]) != tolower(rhs[i])) {
+bool flat_headers::operator==(const flat_headers &rhs) const noexcept {
+  if (size() != rhs.size()) {
+    return false;
+  }
+  for (const value_type &entry : entries_) {
+    const_iterator found = rhs.find(entry.first);
+    if (found == rhs.end() || found->second != entry.second) {
       return false;
     }
   }
   return true;
 }
 
+bool flat_headers::operator!=(const flat_headers &rhs) const noexcept {
+  return !(*this == rhs);
+}
+
+/**\return index of the header or size if there is no such header
+ */
+size_t flat_headers::index_of(std::string_view name) const noexcept {
+  field id = to_field(name);
+  if (id != field::unknown && fields_.empty() == false) {
+    const void *found = memchr(fields_.data(),
+                               static_cast<unsigned char>(id),
+                               fields_.size());
+    return found == NULL ? entries_.size()
+                         : static_cast<const field *>(found) - fields_.data();
+  }
+
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    if (fields_[i] == field::unknown &&
+        detail::iequals(entries_[i].first, name)) {
+      return i;
+    }
+  }
+  return entries_.size();
+}
 
-request::request()
+
+message_view::message_view() noexcept
     : major{-1}
     , minor{-1}
+    , headers_count{0}
+    , known_headers{}
     , content_length{0}
     , keep_alive{false}
-    , body{NULL} {
+    , chunked{false} {
 }
 
+void message_view::reset() noexcept {
+  major = -1;
+  minor = -1;
+  memset(known_headers, 0, sizeof(known_headers));
+  headers_count  = 0;
+  content_length = 0;
+  keep_alive     = false;
+  chunked        = false;
+  body           = std::string_view{};
+}
 
-request_parser::request_parser() noexcept
-    : state_{0}
-    , body_readed_{0} {
-}
-
-request_parser::status request_parser::parse(const void    *buf,
-                                             size_t         len,
-                                             http::request &req,
-                                             size_t        *parsed) noexcept {
-  enum state {
-    none,
-    verb,
-    target,
-    target_colon,
-    target_origin,
-    target_scheme,
-    target_host,
-    target_asterisk,
-    protocol,
-    major,
-    minor,
-    cr,
-    header_key,
-    header_val,
-    second_cr,
-    body,
-  };
-
-  status      retval = status::error;
-  const char *start  = NULL;
-  const char *octets = reinterpret_cast<const char *>(buf);
-  const char *iter   = octets;
-  for (; iter != octets + len; ++iter) {
-    char octet = *iter;
-    retval     = status::error;
-
-    switch (state_) {
-    case none:
-      state_       = verb;
-      body_readed_ = 0;
-      [[fallthrough]];
-    case verb:
-      if (IS_ALPHA(octet)) {
-        if (start == NULL) {
-          start = iter;
-        }
-        retval = status::in_complete;
-      } else if (IS_SPACE(octet)) {
-        if (start != NULL) {
-          req.method = std::string{start, iter};
-          start      = NULL;
-          state_     = target;
-          retval     = status::in_complete;
-        }
-      }
-      break;
-    case target:
-      if (start == NULL) {
-        if (octet == SLASH) {
-          state_ = target_origin;
-          goto TargetOrigin;
-        } else if (octet == ASTERISK) {
-          state_ = target_asterisk;
-          goto TargetAsterisk;
-        } else if (IS_ALPHA(octet)) { // absolute or authority
-          start  = iter;
-          retval = status::in_complete;
-        } else if (IS_SPACE(octet)) {
-          retval = status::in_complete;
-        }
-      } else { // absolute or authority
-        if (octet == COLON) {
-          state_ = target_colon;
-          retval = status::in_complete;
-        } else if (IS_DIGIT(octet) || octet == DOT || octet == SLASH) {
-          state_ = target_host;
-          goto TargetHost;
-        } else if (IS_ALPHA(octet)) {
-          retval = status::in_complete;
-        }
-      }
-      break;
-    case target_colon:
-      if (octet == SLASH) {
-        state_ = target_scheme;
-        retval = status::in_complete;
-      } else if (IS_VCHAR(octet)) {
-        state_ = target_host;
-        retval = status::in_complete;
-      }
-      break;
-    case target_scheme:
-      if (octet == SLASH) { // second slash, like http://
-        start  = NULL;
-        state_ = target_host;
-        retval = status::in_complete;
-      }
-      break;
-    case target_host:
-    TargetHost:
-      if (IS_ALPHA(octet) || IS_DIGIT(octet) || octet == DOT ||
-          octet == COLON) {
-        if (start == NULL) {
-          start = iter;
-        }
-        retval = status::in_complete;
-      } else if (IS_SPACE(octet)) {
-        if (start != NULL) {
-          req.headers[HOST] = std::string{start, iter};
-          req.target        = SLASH;
-          start             = NULL;
-          state_            = protocol;
-          retval            = status::in_complete;
-        }
-      } else if (octet == SLASH) {
-        if (start != NULL) {
-          req.headers[HOST] = std::string{start, iter};
-          start             = NULL;
-          state_            = target_origin;
-          goto TargetOrigin;
-        }
-      }
-      break;
-    case target_origin:
-    TargetOrigin:
-      if (IS_VCHAR(octet)) {
-        if (start == NULL) {
-          start = iter;
-        }
-        retval = status::in_complete;
-      } else if (IS_SPACE(octet)) {
-        if (start != NULL) {
-          req.target = std::string{start, iter};
-          start      = NULL;
-          state_     = protocol;
-          retval     = status::in_complete;
-        }
-      }
-      break;
-    case target_asterisk:
-    TargetAsterisk:
-      req.target = ASTERISK;
-      state_     = protocol;
-      retval     = status::in_complete;
-      break;
-    case protocol:
-      if (IS_ALPHA(octet)) {
-        if (start == NULL) {
-          start = iter;
-        }
-        retval = status::in_complete;
-      } else if (IS_SPACE(octet)) {
-        if (start == NULL) {
-          retval = status::in_complete;
-        } else {
-          retval = status::error;
-        }
-      } else if (octet == SLASH) {
-        if (start != NULL && iter - start == strlen(HTTP) &&
-            strncmp(start, HTTP, strlen(HTTP)) == 0) {
-          state_ = major;
-          start  = NULL;
-          retval = status::in_complete;
-        }
-      }
-      break;
-    case major:
-      if (IS_DIGIT(octet)) {
-        if (start == NULL) {
-          start = iter;
-        }
-        retval = status::in_complete;
-      } else if (octet == DOT) {
-        if (start != NULL) {
-          req.major = atoi(start);
-          start     = NULL;
-          state_    = minor;
-          retval    = status::in_complete;
-        }
-      }
-      break;
-    case minor:
-      if (IS_DIGIT(octet)) {
-        if (start == NULL) {
-          start = iter;
-        }
-        retval = status::in_complete;
-      } else if (octet == CR || octet == LF) {
-        if (start != NULL) {
-          req.minor = atoi(start);
-          start     = NULL;
-          if (octet == CR) {
-            state_ = cr;
-          } else {
-            state_ = header_key;
-          }
-          retval = status::in_complete;
-        }
-      }
-      break;
-    case cr:
-      if (octet == LF) {
-        state_ = header_key;
-        retval = status::in_complete;
-      }
-      break;
-    case header_key:
-      if (IS_VCHAR(octet)) {
-        if (octet == COLON) {
-          if (start != NULL) {
-            header_key_ = std::string{start, iter};
-            start       = NULL;
-            state_      = header_val;
-            retval      = status::in_complete;
-          }
-        } else {
-          if (start == NULL) {
-            start = iter;
-          }
-          retval = status::in_complete;
-        }
-      } else if (start == NULL) {
-        if (IS_SPACE(octet)) {
-          state_ = header_val;
-          retval = status::in_complete;
-        } else if (octet == CR) {
-          state_ = second_cr;
-          retval = status::in_complete;
-        } else if (octet == LF) {
-          goto PreBodyLogic;
-        }
-      }
-      break;
-    case header_val:
-      if (IS_TEXT(octet)) {
-        if (IS_VCHAR(octet)) {
-          if (start == NULL) {
-            start = iter;
-          }
-        } else {
-          if (start != NULL) {
-            if (req.headers.count(header_key_) == 0) {
-              req.headers.emplace(header_key_, std::string{start, iter});
-            } else {
-              std::string &val = req.headers[header_key_];
-              if (val.empty() == false) {
-                val.reserve(val.size() + 1 + iter - start);
-                val.append(" ");
-                req.headers[header_key_].append(start, iter);
-              } else {
-                val = std::string{start, iter};
-              }
-            }
-          } else if ((octet == CR || octet == LF) &&
-                     req.headers.count(header_key_) == 0) {
-            req.headers.emplace(header_key_, "");
-          }
-
-          start = NULL;
-          if (octet == CR) {
-            state_ = cr;
-          } else if (octet == LF) {
-            state_ = header_key;
-          }
-        }
-        retval = status::in_complete;
-      }
-      break;
-    case second_cr:
-      if (octet == LF) {
-      PreBodyLogic:
-        if (req.headers.count(CONNECTION) != 0 &&
-            string_case_insensetive_comp()(req.headers[CONNECTION],
-                                           KEEP_ALIVE)) {
-          req.keep_alive = true;
-        } else {
-          req.keep_alive = false;
-        }
-
-        if (req.headers.count(CONTENT_LENGTH) != 0) {
-          req.content_length = atoi(req.headers[CONTENT_LENGTH].c_str());
-        } else {
-          req.content_length = (octets + len) - (iter + 1);
-        }
-
-        if (req.content_length == 0) {
-          state_ = none;
-          retval = status::done;
-          ++iter;
-        } else {
-          state_ = state::body;
-          retval = (status)(status::headers_done | status::in_complete);
-        }
-      }
-      break;
-    case body: {
-      if (body_readed_ == 0) {
-        req.body = iter;
-      }
-
-      long content_left = req.content_length - body_readed_;
-      long buf_left     = octets + len - iter;
-      if (content_left == buf_left) {
-        body_readed_ += content_left;
-        state_ = none;
-        retval = status::done;
-        iter   = octets + len;
-      } else if (content_left < buf_left) {
-        body_readed_ += content_left;
-        state_ = none;
-        retval = status::done;
-        iter += content_left;
-      } else {
-        body_readed_ += buf_left;
-        state_ = state::body;
-        retval = (status)(status::headers_done | status::in_complete);
-        iter   = octets + len - 1 /*because we increment iter in for loop*/;
-      }
-    } break;
-    default:
-      break;
+std::string_view message_view::header(std::string_view name) const noexcept {
+  field id = to_field(name);
+  if (id != field::unknown) {
+    return header(id);
+  }
+
+  for (size_t i = 0; i < headers_count; ++i) {
+    if (detail::iequals(headers[i].name, name)) {
+      return headers[i].value;
     }
+  }
+  return std::string_view{};
+}
 
-    if (retval == status::error) {
-      state_ = none;
-      break;
-    } else if ((retval & status::in_complete) == false) {
-      // parsing is done
-      break;
+std::string_view message_view::header(field id) const noexcept {
+  unsigned char index = known_headers[static_cast<size_t>(id)];
+  if (index == 0) {
+    return std::string_view{};
+  }
+  return headers[index - 1].value;
+}
+
+request_view::request_view() noexcept
+    : method_id{verb::unknown} {
+}
+
+void request_view::reset() noexcept {
+  message_view::reset();
+  method    = std::string_view{};
+  method_id = verb::unknown;
+  target    = std::string_view{};
+}
+
+
+lazy_request_view::lazy_request_view() noexcept
+    : method_id{verb::unknown}
+    , major{-1}
+    , minor{-1}
+    , content_length{0}
+    , keep_alive{false}
+    , chunked{false}
+    , headers_count_{0}
+    , known_headers_{}
+    , indexed_{true} {
+}
+
+void lazy_request_view::reset() noexcept {
+  method       = std::string_view{};
+  method_id    = verb::unknown;
+  target       = std::string_view{};
+  major        = -1;
+  minor        = -1;
+  header_block = std::string_view{};
+  memset(known_headers_, 0, sizeof(known_headers_));
+  headers_count_ = 0;
+  indexed_       = true;
+  content_length = 0;
+  keep_alive     = false;
+  chunked        = false;
+  body           = std::string_view{};
+}
+
+std::string_view
+lazy_request_view::header(std::string_view name) const noexcept {
+  field id = to_field(name);
+  if (id != field::unknown) {
+    return header(id);
+  }
+
+  index();
+  for (size_t i = 0; i < headers_count_; ++i) {
+    if (detail::iequals(headers_[i].name, name)) {
+      return headers_[i].value;
     }
   }
-  if (parsed) {
-    *parsed = iter - octets;
+  return std::string_view{};
+}
+
+std::string_view lazy_request_view::header(field id) const noexcept {
+  index();
+  unsigned char index = known_headers_[static_cast<size_t>(id)];
+  if (index == 0) {
+    return std::string_view{};
+  }
+  return headers_[index - 1].value;
+}
+
+const header_field *lazy_request_view::headers() const noexcept {
+  index();
+  return headers_;
+}
+
+size_t lazy_request_view::headers_count() const noexcept {
+  index();
+  return headers_count_;
+}
+
+void lazy_request_view::add_header(field            id,
+                                   std::string_view name,
+                                   std::string_view value) const noexcept {
+  headers_[headers_count_++] = header_field{name, value};
+
+  unsigned char &index = known_headers_[static_cast<size_t>(id)];
+  if (id != field::unknown && index == 0) {
+    index = headers_count_;
+  }
+}
+
+void lazy_request_view::index() const noexcept {
+  if (indexed_) {
+    return;
+  }
+  indexed_ = true;
+
+  // the block was validated by the parser, so every line contains colon and
+  // is finished by CRLF
+  const char *iter = header_block.data();
+  const char *end  = header_block.data() + header_block.size();
+  while (iter != end && headers_count_ != max_headers) {
+    const char *colon =
+        static_cast<const char *>(memchr(iter, ':', end - iter));
+    const char *cr =
+        static_cast<const char *>(memchr(colon, '\r', end - colon));
+
+    std::string_view name{iter, static_cast<size_t>(colon - iter)};
+    std::string_view value{colon + 1, static_cast<size_t>(cr - colon - 1)};
+    while (value.empty() == false &&
+           (value.front() == ' ' || value.front() == '\t')) {
+      value.remove_prefix(1);
+    }
+    add_header(to_field(name), name, detail::trim_value(value));
+    iter = cr + 2;
+  }
+}
+
+
+spill_buffer::spill_buffer(size_t capacity) noexcept
+    : last_{nullptr}
+    , size_{0}
+    , capacity_{capacity} {
+}
+
+bool spill_buffer::contains(std::string_view view) const noexcept {
+  // blocks and view can be unrelated objects, so pointers are compared by
+  // std::less, which is total order
+  std::less<const char *> less;
+  for (const block *iter = first_.get(); iter != nullptr;
+       iter              = iter->next.get()) {
+    const char *begin = iter->data.get();
+    if (less(view.data(), begin) == false &&
+        less(begin + iter->size, view.data() + view.size()) == false) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool spill_buffer::save(std::string_view &view) noexcept {
+  if (view.empty() || contains(view)) {
+    return true;
+  } else if (capacity_ - size_ < view.size()) {
+    return false;
+  }
+
+  char *place = reserve(view.size());
+  if (place == nullptr) {
+    return false;
+  }
+  memcpy(place, view.data(), view.size());
+  last_->size += view.size();
+  size_ += view.size();
+  view = std::string_view{place, view.size()};
+  return true;
+}
+
+bool spill_buffer::extend(std::string_view &view,
+                          std::string_view  tail) noexcept {
+  if (last_ == nullptr ||
+      view.data() + view.size() != last_->data.get() + last_->size) {
+    return false;
+  } else if (capacity_ - size_ < tail.size()) {
+    return false;
+  }
+
+  if (last_->capacity - last_->size < tail.size()) {
+    // view is moved to new block, its old copy is not counted anymore
+    char *place = reserve(view.size() + tail.size());
+    if (place == nullptr) {
+      return false;
+    }
+    memcpy(place, view.data(), view.size());
+    last_->size += view.size();
+    view = std::string_view{place, view.size()};
+  }
+
+  memcpy(last_->data.get() + last_->size, tail.data(), tail.size());
+  last_->size += tail.size();
+  size_ += tail.size();
+  view = std::string_view{view.data(), view.size() + tail.size()};
+  return true;
+}
+
+void spill_buffer::clear() noexcept {
+  if (first_ != nullptr) {
+    first_->next.reset();
+    first_->size = 0;
+  }
+  last_ = first_.get();
+  size_ = 0;
+}
+
+size_t spill_buffer::capacity() const noexcept {
+  return capacity_;
+}
+
+char *spill_buffer::reserve(size_t count) noexcept {
+  if (last_ != nullptr && last_->capacity - last_->size >= count) {
+    return last_->data.get() + last_->size;
+  }
+
+  size_t size = std::min(first_block, capacity_);
+  if (last_ != nullptr) {
+    size = std::min(last_->capacity * 2, capacity_);
+  }
+  size = std::max(size, count);
+
+  std::unique_ptr<block> next{new (std::nothrow) block{}};
+  if (next == nullptr) {
+    return nullptr;
+  }
+  next->data.reset(new (std::nothrow) char[size]);
+  if (next->data == nullptr) {
+    return nullptr;
+  }
+  next->size     = 0;
+  next->capacity = size;
+
+  block *added = next.get();
+  if (last_ == nullptr) {
+    first_ = std::move(next);
+  } else {
+    last_->next = std::move(next);
+  }
+  last_ = added;
+  return added->data.get();
+}
+
+request_parser_base::request_parser_base(size_t               spill_capacity,
+                                         const parser_limits &limits) noexcept
+    : state_{0}
+    , error_{parse_error::none}
+    , method_{http::verb::unknown}
+    , status_code_{0}
+    , limits_{limits}
+    , spill_{spill_capacity != default_spill_capacity
+                 ? spill_capacity
+                 : request_parser_base::spill_capacity(limits)}
+    , header_field_{field::unknown}
+    , major_{-1}
+    , content_length_{0}
+    , keep_alive_{false}
+    , chunked_{false}
+    , transfer_encoding_{false}
+    , trailers_{false}
+    , hosts_{0}
+    , body_readed_{0}
+    , chunk_left_{0}
+    , line_size_{0}
+    , header_bytes_{0}
+    , headers_count_{0} {
+}
+
+size_t
+request_parser_base::spill_capacity(const parser_limits &limits) noexcept {
+  // ": " and CRLF of every line are saved with header block of lazy view
+  size_t separators = std::min(limits.headers_count, SIZE_MAX / 4) * 4;
+  size_t retval     = limits.request_line;
+  for (size_t part : {limits.header_bytes, separators}) {
+    retval = part > SIZE_MAX - retval ? SIZE_MAX : retval + part;
   }
   return retval;
 }
 
-void request_parser::clear() noexcept {
-  state_ = 0;
-  header_key_.clear();
-  body_readed_ = 0;
+bool request_parser_base::take_token(const char       *begin,
+                                     const char       *end,
+                                     std::string_view &token) noexcept {
+  if (token_.empty()) {
+    token = detail::to_view(begin, end);
+    return true;
+  }
+
+  token  = token_;
+  token_ = std::string_view{};
+  return spill_.extend(token, detail::to_view(begin, end));
+}
+
+void request_parser_base::clear() noexcept {
+  state_       = 0;
+  error_       = parse_error::none;
+  method_      = http::verb::unknown;
+  status_code_ = 0;
+  spill_.clear();
+  token_             = std::string_view{};
+  header_name_       = std::string_view{};
+  header_field_      = field::unknown;
+  chunked_           = false;
+  transfer_encoding_ = false;
+  trailers_          = false;
+  hosts_             = 0;
+  body_readed_       = 0;
+  chunk_left_        = 0;
+  line_size_         = 0;
+  header_bytes_      = 0;
+  headers_count_     = 0;
+}
+
+parse_error request_parser_base::last_error() const noexcept {
+  return error_;
+}
+
+size_t request_parser_base::body_left() const noexcept {
+  if (state_ == body) {
+    return content_length_ - body_readed_;
+  } else if (state_ == chunk_data) {
+    return chunk_left_;
+  }
+  return 0;
+}
+
+request_parser_base::status
+request_parser_base::skip_body(size_t count) noexcept {
+  if (state_ == body) {
+    body_readed_ += count;
+    if (body_readed_ == content_length_) {
+      state_ = none;
+      return status::done;
+    }
+  } else if (state_ == chunk_data) {
+    chunk_left_ -= count;
+    if (chunk_left_ == 0) {
+      state_ = chunk_data_cr;
+    }
+  }
+  return (status)(status::headers_done | status::in_complete);
+}
+
+bool request_parser_base::idle() const noexcept {
+  return state_ == none;
+}
+
+bool request_parser_base::suspendable() const noexcept {
+  // trailers are parsed as headers, chunk states are never set for them
+  return state_ == none || (state_ >= body && state_ <= chunk_data_lf);
+}
+
+parser_state request_parser_base::suspend() const noexcept {
+  parser_state retval;
+  retval.body_readed = body_readed_;
+  retval.body_left =
+      state_ == body ? content_length_ - body_readed_ : chunk_left_;
+  retval.state = state_;
+  return retval;
+}
+
+void request_parser_base::resume(const parser_state &state) noexcept {
+  clear();
+  state_       = state.state;
+  body_readed_ = state.body_readed;
+  chunked_     = state_ > body;
+  if (state_ == body) {
+    content_length_ = state.body_readed + state.body_left;
+  } else {
+    chunk_left_ = state.body_left;
+  }
 }
 } // namespace http
@@ -1,19 +1,35 @@
 #pragma once
 
+#include "http_fields.hpp"
+#include "http_scan.hpp"
+#include "http_stats.hpp"
+#include "http_verb.hpp"
 #include <cstddef>
+#include <memory>
+#include <cstdint>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace http {
-class request_parser;
+class request_view;
 
+namespace detail {
+class lazy_request_view_builder;
+} // namespace detail
+
+/**\brief doesn't copy the string, and for well known header names uses
+ * perfect hash
+ */
 struct string_case_insensetive_hash {
-  std::size_t operator()(std::string str) const noexcept;
+  std::size_t operator()(std::string_view str) const noexcept;
 };
 
 struct string_case_insensetive_comp {
-  bool operator()(const std::string &lhs,
-                  const std::string &rhs) const noexcept;
+  bool operator()(std::string_view lhs, std::string_view rhs) const noexcept;
 };
 
 
@@ -22,23 +38,497 @@ using headers = std::unordered_map<std::string,
                                    string_case_insensetive_hash,
                                    string_case_insensetive_comp>;
 
-class request {
-  friend request_parser;
+/**\brief same as headers, but all memory is allocated from memory resource,
+ * so it can be placed in arena, that is released at once
+ */
+using pmr_headers = std::pmr::unordered_map<std::pmr::string,
+                                            std::pmr::string,
+                                            string_case_insensetive_hash,
+                                            string_case_insensetive_comp>;
+
+/**\brief alternative for headers, which keeps all headers in one vector, so
+ * it needs less allocations and lookup doesn't chase pointers. Lookup is
+ * linear, but for well known names it compares only one octet per header
+ * \note names are case insensetive, same as for headers
+ */
+class flat_headers {
+public:
+  using key_type       = std::string;
+  using mapped_type    = std::string;
+  using value_type     = std::pair<std::string, std::string>;
+  using iterator       = std::vector<value_type>::iterator;
+  using const_iterator = std::vector<value_type>::const_iterator;
+  using allocator_type = std::allocator<value_type>;
+
+  static constexpr size_t default_capacity = 16;
+
+  flat_headers() = default;
+  explicit flat_headers(const allocator_type &alloc);
+
+  iterator       begin() noexcept;
+  iterator       end() noexcept;
+  const_iterator begin() const noexcept;
+  const_iterator end() const noexcept;
+
+  size_t size() const noexcept;
+  bool   empty() const noexcept;
+
+  /**\brief remove all headers, but keep allocated memory
+   */
+  void clear() noexcept;
+  void reserve(size_t capacity);
+
+  iterator       find(std::string_view name) noexcept;
+  const_iterator find(std::string_view name) const noexcept;
+  size_t         count(std::string_view name) const noexcept;
+
+  /**\return value of the header, if there is no such header, then it will be
+   * added with empty value
+   */
+  std::string &operator[](std::string_view name);
+
+  /**\brief add the header if there is no header with same name
+   */
+  std::pair<iterator, bool> emplace(std::string_view name,
+                                    std::string_view value);
+
+  /**\brief headers are equal if they contain same values for same names,
+   * order is not important
+   */
+  bool operator==(const flat_headers &rhs) const noexcept;
+  bool operator!=(const flat_headers &rhs) const noexcept;
 
+private:
+  size_t index_of(std::string_view name) const noexcept;
+
+  std::vector<value_type> entries_;
+  /**\brief well known field for every entry, so lookup by known name is
+   * search of one octet
+   */
+  std::vector<field> fields_;
+};
+
+/**\brief owning request
+ * \tparam Headers container for headers: http::headers, http::flat_headers or
+ * http::pmr_headers. Method and target use same string type as the headers
+ */
+template <typename Headers>
+class basic_request {
 public:
-  request();
+  using headers_type   = Headers;
+  using string_type    = typename Headers::mapped_type;
+  using allocator_type = typename Headers::allocator_type;
+
+  basic_request();
+
+  /**\brief all strings and headers will use the allocator, for
+   * http::pmr_request it can be std::pmr::memory_resource *
+   */
+  explicit basic_request(const allocator_type &alloc);
+
+  /**\brief build owning request from view, header values are normalized and
+   * merged in same way as request_parser does it
+   */
+  explicit basic_request(const request_view &view);
+
+  /**\brief restore default state, but keep capacity of strings and headers, so
+   * the request can be reused for next request without new allocations
+   */
+  void reset() noexcept;
+
+  string_type method;
+  /**\brief well known method, or verb::unknown
+   */
+  http::verb  method_id;
+  string_type target;
+  int         major;
+  int         minor;
+  Headers     headers;
+  size_t      content_length;
+  bool        keep_alive;
+  /**\brief message body is encoded by chunked transfer coding, so body is
+   * reported by chunks, and content_length is always 0
+   */
+  bool chunked;
+  /**\brief first body octets, or data of last chunk that was found by parse
+   * for chunked message. Chunk must be handled before next parse call
+   */
+  const void *body;
+  /**\brief count of octets pointed by body
+   */
+  size_t body_size;
+};
+
+using request      = basic_request<http::headers>;
+using flat_request = basic_request<http::flat_headers>;
+using pmr_request  = basic_request<http::pmr_headers>;
+
+struct header_field {
+  std::string_view name;
+  std::string_view value;
+};
+
+/**\brief fields of non-owning request or response after its start line, all
+ * of them point to buffer that was parsed, so the message is valid only while
+ * the buffer is alive
+ * \note header values are not normalized: value contains all octets between
+ * first and last visible character. Repeated headers and multiline
+ * continuations are stored as separate fields with same name
+ */
+class message_view {
+public:
+  static constexpr std::size_t max_headers = 64;
+
+  message_view() noexcept;
+
+  /**\brief restore default state
+   */
+  void reset() noexcept;
+
+  /**\return value of first header with the name (case insensetive) or empty
+   * view if there is no such header
+   */
+  std::string_view header(std::string_view name) const noexcept;
+
+  /**\brief same as previous, but for well known header it costs only one
+   * lookup in known_headers
+   */
+  std::string_view header(field id) const noexcept;
+
+  int              major;
+  int              minor;
+  header_field     headers[max_headers];
+  size_t           headers_count;
+  /**\brief index + 1 of first header in headers for every well known field, 0
+   * if there is no such header
+   */
+  unsigned char    known_headers[field_count];
+  size_t           content_length;
+  bool             keep_alive;
+  bool             chunked;
+  /**\brief body octets that were found in last parsed buffer, or data of last
+   * chunk that was found by parse for chunked message
+   */
+  std::string_view body;
+};
+
+/**\brief non-owning variant of request, headers and body are kept by
+ * message_view
+ */
+class request_view : public message_view {
+public:
+  request_view() noexcept;
+
+  /**\brief restore default state
+   */
+  void reset() noexcept;
+
+  std::string_view method;
+  http::verb       method_id;
+  std::string_view target;
+};
+
+/**\brief variant of request_view, which keeps header block as is and splits
+ * it only at first lookup, so request, whose headers are not inspected, costs
+ * only one scan for end of headers
+ * \note if headers are split between buffers or contain multiline values, then
+ * they are parsed one by one, in that case header_block is empty
+ */
+class lazy_request_view {
+  friend detail::lazy_request_view_builder;
+
+public:
+  static constexpr std::size_t max_headers = request_view::max_headers;
+
+  lazy_request_view() noexcept;
+
+  /**\brief restore default state
+   */
+  void reset() noexcept;
+
+  /**\return value of first header with the name (case insensetive) or empty
+   * view if there is no such header
+   */
+  std::string_view header(std::string_view name) const noexcept;
+  std::string_view header(field id) const noexcept;
+
+  /**\return all headers, header block is indexed at first call
+   */
+  const header_field *headers() const noexcept;
+  size_t              headers_count() const noexcept;
+
+  std::string_view method;
+  http::verb       method_id;
+  std::string_view target;
+  int              major;
+  int              minor;
+  /**\brief header lines with CRLF of last line, but without empty line. If
+   * body is split between buffers, then the block is saved in the parser
+   */
+  std::string_view header_block;
+  size_t           content_length;
+  bool             keep_alive;
+  bool             chunked;
+  std::string_view body;
+
+private:
+  void add_header(field            id,
+                  std::string_view name,
+                  std::string_view value) const noexcept;
+
+  /**\brief split header block, if it is not done yet
+   */
+  void index() const noexcept;
+
+  /**\brief headers reported one by one, and then headers from the block
+   */
+  mutable header_field  headers_[max_headers];
+  mutable size_t        headers_count_;
+  mutable unsigned char known_headers_[field_count];
+  mutable bool          indexed_;
+};
+
+/**\brief storage for tokens that were split between several buffers. Memory is
+ * allocated by blocks, which grow twice up to capacity, and saved data is never
+ * moved, so saved views are valid until clear. Clear keeps only first block
+ */
+class spill_buffer {
+public:
+  /**\brief size of first block, it is enough for typical request line and
+   * headers
+   */
+  static constexpr size_t first_block = 4 * 1024;
+
+  /**\param capacity maximum count of saved octets
+   */
+  explicit spill_buffer(size_t capacity) noexcept;
+
+  bool contains(std::string_view view) const noexcept;
+
+  /**\brief copy the view to the storage, if it is not there yet, and point the
+   * view to the copy
+   * \return false if there is no enough space
+   */
+  bool save(std::string_view &view) noexcept;
+
+  /**\brief append tail to the view, which must be last saved view. The view
+   * is moved to next block, if the tail doesn't fit in current one
+   * \return false if there is no enough space
+   */
+  bool extend(std::string_view &view, std::string_view tail) noexcept;
+
+  void clear() noexcept;
+
+  size_t capacity() const noexcept;
+
+private:
+  struct block {
+    std::unique_ptr<block>  next;
+    std::unique_ptr<char[]> data;
+    size_t                  size;
+    size_t                  capacity;
+  };
+
+  /**\return place for count octets at end of last block, new block is
+   * allocated if there is no enough space in it
+   */
+  char *reserve(size_t count) noexcept;
+
+  std::unique_ptr<block> first_;
+  block                 *last_;
+  /**\brief count of saved octets in all blocks
+   */
+  size_t                 size_;
+  size_t                 capacity_;
+};
+
+/**\brief base class for handlers of request_parser::parse. Handler can hide
+ * any of the callbacks, they are called without virtual dispatch, so callbacks
+ * that are not hidden cost nothing
+ * \note views point to parsed buffer or to spill buffer of the parser, which
+ * is cleared at start of next request
+ */
+class request_handler {
+public:
+  /**\brief if true, then parse returns after every chunk data, so caller can
+   * handle the chunk before the next one is parsed
+   */
+  static constexpr bool stop_after_chunk = false;
+
+  /**\brief if true, then headers, which are completely in parsed buffer, are
+   * not split by the parser, but reported at once by on_header_block. Only
+   * framing headers are parsed from the block
+   */
+  static constexpr bool lazy_headers = false;
+
+  void on_message_begin() noexcept {
+  }
+
+  /**\param id well known method or verb::unknown
+   */
+  void on_method(verb /*id*/, std::string_view /*method*/) noexcept {
+  }
+
+  /**\note for absolute and authority form of target, authority is reported by
+   * on_header as Host header
+   */
+  void on_target(std::string_view /*target*/) noexcept {
+  }
+
+  void on_version(int /*major*/, int /*minor*/) noexcept {
+  }
+
+  /**\brief called for every header and trailer, value is trimmed, but not
+   * normalized
+   * \param id well known field of the header or field::unknown, so handler
+   * doesn't need to compare names
+   * \return false if parsing must be finished with error
+   */
+  bool on_header(field /*id*/,
+                 std::string_view /*name*/,
+                 std::string_view /*value*/) noexcept {
+    return true;
+  }
+
+  /**\brief called instead of on_header, if lazy_headers is true and all
+   * headers are in parsed buffer. Block contains header lines, every line is
+   * finished by CRLF, there are no multiline values
+   * \param count count of headers in the block
+   * \return false if parsing must be finished with error
+   */
+  bool on_header_block(std::string_view /*block*/, size_t /*count*/) noexcept {
+    return true;
+  }
+
+  /**\brief called after all headers, before body
+   */
+  void on_headers_complete(size_t /*content_length*/,
+                           bool /*keep_alive*/,
+                           bool /*chunked*/) noexcept {
+  }
 
-  std::string   method;
-  std::string   target;
-  int           major;
-  int           minor;
-  http::headers headers;
-  size_t        content_length;
-  bool          keep_alive;
-  const void *  body;
+  /**\brief called for every part of body that was found in parsed buffer, or
+   * for every chunk data for chunked message
+   */
+  void on_body(std::string_view /*data*/) noexcept {
+  }
+
+  void on_message_complete() noexcept {
+  }
+
+  /**\brief called if buffer ended before message is complete. After this call
+   * all reported views, that point to the buffer, are not valid anymore, so
+   * the handler can save them in the spill buffer
+   * \return false if parsing must be finished with error
+   */
+  bool on_suspend(spill_buffer & /*spill*/) noexcept {
+    return true;
+  }
 };
 
-class request_parser {
+/**\brief limits of request, that are checked while parsing, so abusive
+ * request is rejected as soon as any limit is exceeded
+ */
+struct parser_limits {
+  /**\brief maximum size of method and target
+   */
+  size_t request_line = 8 * 1024;
+  /**\brief maximum total size of names and values of headers and trailers
+   */
+  size_t header_bytes = 64 * 1024;
+  /**\brief maximum count of headers and trailers, by default every header
+   * fits in request_view
+   */
+  size_t headers_count = request_view::max_headers;
+  /**\brief maximum size of body, for chunked message it is total size of all
+   * chunks
+   */
+  size_t body = SIZE_MAX - 1;
+};
+
+/**\brief reason of last error returned by parser
+ */
+enum class parse_error : unsigned char {
+  none,
+  bad_request,
+  request_line_too_long,
+  headers_too_large,
+  too_many_headers,
+  body_too_large,
+  /**\brief token that was split between buffers doesn't fit in spill buffer
+   */
+  spill_overflow,
+  /**\brief handler returned false from on_header
+   */
+  rejected_by_handler,
+};
+
+static_assert(static_cast<size_t>(parse_error::rejected_by_handler) + 1 ==
+                  stats::error_count,
+              "stats must have counters for every error");
+
+/**\brief compile time options of basic_request_parser, branches for disabled
+ * features are removed from the parser. Custom policy can be inherited from
+ * one of the policies and hide some of the options
+ */
+struct default_policy {
+  /**\brief accept LF without CR as end of line, tabs and repeated spaces as
+   * separators of request line, and multiline header values
+   */
+  static constexpr bool lenient = true;
+  /**\brief accept absolute and authority form of target, otherwise only
+   * origin and asterisk form are accepted
+   */
+  static constexpr bool absolute_form = true;
+  /**\brief report headers to handler, otherwise headers are skipped, only
+   * framing headers are parsed
+   */
+  static constexpr bool capture_headers = true;
+  /**\brief collect counters of parsed requests and errors, and cycles spent
+   * in every phase of request
+   * \see stats::collect
+   */
+  static constexpr bool stats = false;
+  /**\brief request without Content-Length and chunked Transfer-Encoding
+   * takes all octets to end of buffer as body. If false, such request has no
+   * body (RFC 9112 6.3), so it can be pipelined
+   */
+  static constexpr bool body_to_end = true;
+  /**\brief parse status line of response instead of request line, it is set
+   * by basic_response_parser
+   */
+  static constexpr bool response = false;
+};
+
+/**\brief follows RFC 9112 strictly: every line must be finished by CRLF,
+ * parts of request line are separated by one space, multiline header values
+ * are rejected, request with both Transfer-Encoding and Content-Length is
+ * rejected, request without Content-Length has no body
+ */
+struct strict_policy : default_policy {
+  static constexpr bool lenient     = false;
+  static constexpr bool body_to_end = false;
+};
+
+/**\brief compact state of the parser, which can be kept by idle connection
+ * instead of the parser, so one parser serves many connections
+ * \see request_parser_base::suspend
+ */
+struct parser_state {
+  /**\brief octets of body, that are already parsed
+   */
+  uint64_t body_readed;
+  /**\brief octets left in body or in current chunk
+   */
+  uint64_t body_left;
+  uint8_t  state;
+};
+
+static_assert(sizeof(parser_state) <= 24, "state must be compact");
+
+/**\brief part of the parser, that doesn't depend on policy
+ */
+class request_parser_base {
 public:
   enum status {
     error        = 0b000,
@@ -48,24 +538,266 @@ public:
     done         = 0b110,
   };
 
-  request_parser() noexcept;
+  /**\brief spill capacity is derived from limits of the parser
+   * \see spill_capacity
+   */
+  static constexpr size_t default_spill_capacity = 0;
+
+  /**\brief result of parse_batch
+   */
+  struct batch {
+    /**\brief count of complete requests
+     */
+    size_t count;
+    /**\brief count of parsed octets, next parsing must start from here
+     */
+    size_t parsed;
+    /**\brief status of last parsed request. If it is in_complete, then
+     * reqs[count] contains the incomplete request
+     */
+    enum status last;
+  };
+
+  /**\brief states of the parser, stats::snapshot::error_states is indexed
+   * by them
+   */
+  enum state {
+    none,
+    verb,
+    target,
+    target_colon,
+    target_origin,
+    target_scheme,
+    target_host,
+    target_asterisk,
+    protocol,
+    major,
+    minor,
+    status_code,
+    reason,
+    cr,
+    header_key,
+    header_val,
+    second_cr,
+    body,
+    chunk_start,
+    chunk_size,
+    chunk_bws,
+    chunk_ext,
+    chunk_size_lf,
+    chunk_data,
+    chunk_data_cr,
+    chunk_data_lf,
+    state_count,
+  };
+
+  static_assert(state_count == stats::state_count,
+                "stats must have counters for every state");
+
+  /**\param spill_capacity maximum count of octets, that can be saved by the
+   * parser, if request line or headers are split between several buffers,
+   * default_spill_capacity to derive it from limits
+   * \param limits limits for every parsed request
+   */
+  request_parser_base(size_t               spill_capacity,
+                      const parser_limits &limits) noexcept;
+
+  /**\return spill capacity, which is enough to save all fields of request
+   * within the limits: request line, headers and separators of header block.
+   * Memory of spill is allocated only when request is split
+   */
+  static size_t spill_capacity(const parser_limits &limits) noexcept;
+
+  /**\brief restore parser to default state
+   */
+  void clear() noexcept;
+
+  /**\return reason of error, if last parse returned error, otherwise
+   * parse_error::none
+   */
+  parse_error last_error() const noexcept;
+
+  /**\return count of body octets of current message, which can be consumed
+   * without parsing by skip_body: rest of body for message with
+   * Content-Length, or rest of current chunk data for chunked message
+   */
+  size_t body_left() const noexcept;
+
+  /**\brief consume body octets, that were handled without parsing, for
+   * example moved from socket to file by body_sink. Body is not reported to
+   * handler, and on_message_complete is not called
+   * \param count must not be greater then body_left()
+   * \return done if the message is complete, otherwise
+   * headers_done | in_complete
+   */
+  enum status skip_body(size_t count) noexcept;
+
+  /**\return true if no request is started
+   */
+  bool idle() const noexcept;
+
+  /**\return true if the parser doesn't keep any parsed token, so its state
+   * can be saved by suspend: between requests and inside body
+   */
+  bool suspendable() const noexcept;
+
+  /**\return state of current connection, parser must be suspendable. After
+   * that the parser can parse other connection
+   * \note fields of suspended request are not kept, so request must be
+   * handled before, only its body is parsed after resume
+   */
+  parser_state suspend() const noexcept;
+
+  /**\brief continue parsing of connection, that was suspended
+   */
+  void resume(const parser_state &state) noexcept;
+
+protected:
+  static stats::phase phase_of(int state) noexcept;
+
+  /**\brief set token to current token, which can be started in previous
+   * buffer
+   * \return false if the token can not be saved
+   */
+  bool take_token(const char *      begin,
+                  const char *      end,
+                  std::string_view &token) noexcept;
+
+  /**\brief update framing of message by the header, sets error_ if value is
+   * not valid
+   */
+  void on_framing_header(field id, std::string_view value) noexcept;
+
+  /**\brief account and validate header lines in [begin, end), every line must
+   * be finished by CRLF, and parse framing headers from them
+   * \return false if the lines must be parsed one by one, or if error_ is set
+   */
+  bool scan_header_block(const scan::kernels &scanner,
+                         const char *         begin,
+                         const char *         end) noexcept;
+
+  /**\brief state machine of request and response, policy selects start line
+   * and framing rules of the message
+   */
+  template <typename Policy, typename Handler>
+  enum status run(const void *buf,
+                  size_t      len,
+                  Handler &   handler,
+                  size_t *    parsed) noexcept;
+
+  int              state_;
+  parse_error      error_;
+  /**\brief method of request, which response is parsed, it is used only by
+   * response parser
+   */
+  http::verb       method_;
+  unsigned short   status_code_;
+  parser_limits    limits_;
+  spill_buffer     spill_;
+  std::string_view token_;
+  std::string_view header_name_;
+  field            header_field_;
+  int              major_;
+  size_t           content_length_;
+  bool             keep_alive_;
+  bool             chunked_;
+  /**\brief Transfer-Encoding header is present, chunked or not
+   */
+  bool             transfer_encoding_;
+  bool             trailers_;
+  /**\brief count of received Host headers, Host of absolute form target is not
+   * counted
+   */
+  size_t           hosts_;
+  size_t           body_readed_;
+  size_t           chunk_left_;
+  size_t           line_size_;
+  size_t           header_bytes_;
+  size_t           headers_count_;
+};
+
+/**\tparam Policy compile time options of the parser
+ * \see default_policy
+ */
+template <typename Policy>
+class basic_request_parser : public request_parser_base {
+public:
+  using policy_type = Policy;
+
+  /**\param spill_capacity maximum count of octets, that can be saved by the
+   * parser, if request line or headers are split between several buffers
+   * \param limits limits for every parsed request
+   */
+  explicit basic_request_parser(
+      size_t               spill_capacity = default_spill_capacity,
+      const parser_limits &limits         = parser_limits{}) noexcept;
 
   /**\param parsed capacity of octets that was parsed
    * \note if Content-Length is empty, then parser assume that message in buffer
    * is complete, so all octets after header will be marked as message body
+   * \note request can be split between any count of buffers, tokens that are
+   * split will be saved in the parser. If the tokens are greater then spill
+   * capacity, then error will be returned
+   * \note for chunked message parsing stops after every chunk data, so
+   * headers_done | in_complete is returned and parsed points after the data.
+   * done is returned after last chunk and trailers, which are added to headers.
+   * Rest of the buffer must be parsed by next call before the buffer is
+   * changed, because fields are saved only when whole buffer is parsed
    */
-  enum status parse(const void *   buf,
-                    size_t         len,
-                    http::request &req,
-                    size_t *       parsed = NULL) noexcept;
+  template <typename Headers>
+  enum status parse(const void *                  buf,
+                    size_t                        len,
+                    http::basic_request<Headers> &req,
+                    size_t *                      parsed = NULL) noexcept;
 
-  /**\brief restore parser to default state
+  /**\brief same as previous, but doesn't allocate any memory if request line
+   * and headers are in one buffer. Otherwise all parsed fields will be saved
+   * in the parser, so they are valid until next request is started. Body
+   * always points to last buffer
+   * \return error if request contains more then request_view::max_headers
+   * headers, or spill_overflow if spill capacity is less then
+   * spill_capacity(limits) and the fields don't fit in it
    */
-  void clear() noexcept;
+  enum status parse(const void *        buf,
+                    size_t              len,
+                    http::request_view &req,
+                    size_t *            parsed = NULL) noexcept;
 
-private:
-  int         state_;
-  std::string header_key_;
-  size_t      body_readed_;
+  /**\brief same as previous, but header block is not split while parsing, if
+   * it is in one buffer
+   * \see lazy_request_view
+   */
+  enum status parse(const void *             buf,
+                    size_t                   len,
+                    http::lazy_request_view &req,
+                    size_t *                 parsed = NULL) noexcept;
+
+  /**\brief parse all pipelined requests from the buffer in one call, so
+   * event loop can dispatch all of them at once
+   * \param reqs array of count requests for parsed requests
+   * \note if last request is not complete, then parsing of it must be continued
+   * with the same request_view, so it must be first in reqs for next call
+   * \note request that was started in previous buffer may point to spill
+   * buffer, which is cleared by next request, so parsing stops after it
+   */
+  batch parse_batch(const void *  buf,
+                    size_t        len,
+                    request_view *reqs,
+                    size_t        count) noexcept;
+
+  /**\brief parse request and report its parts to the handler, so the parser
+   * doesn't build anything itself
+   * \see request_handler
+   */
+  template <typename Handler>
+  enum status parse(const void *buf,
+                    size_t      len,
+                    Handler &   handler,
+                    size_t *    parsed = NULL) noexcept;
 };
+
+using request_parser        = basic_request_parser<default_policy>;
+using strict_request_parser = basic_request_parser<strict_policy>;
 } // namespace http
+
+#include "http_request_parser_impl.hpp"
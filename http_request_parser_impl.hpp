@@ -0,0 +1,1485 @@
+#pragma once
+// implementation of basic_request_parser template functions, don't include it
+// directly, use http_request_parser.hpp
+
+#include "http_fields.hpp"
+#include "http_scan.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#define HTTP       "HTTP"
+#define CHUNKED    "chunked"
+#define KEEP_ALIVE "Keep-Alive"
+#define CLOSE      "close"
+
+#define IS_UPALPHA(ch) ((ch) >= 'A' && (ch) <= 'Z')
+#define IS_LOALPHA(ch) ((ch) >= 'a' && (ch) <= 'z')
+#define IS_ALPHA(ch)   (IS_UPALPHA(ch) || IS_LOALPHA(ch))
+#define IS_DIGIT(ch)   ((ch) >= '0' && (ch) <= '9')
+#define IS_CTL(ch)     (((ch) > 0 && (ch) < 31 && (ch) != '\t') || (ch) == 127)
+#define IS_VCHAR(ch)   ((ch) >= 33 && (ch) <= 126)
+#define CR             '\r'
+#define LF             '\n'
+#define CRLF           "\r\n"
+#define SP             ' '
+#define HT             '\t'
+#define SLASH          '/'
+#define COLON          ':'
+#define ASTERISK       '*'
+
+#define DOT '.'
+
+#define IS_TEXT(ch) (IS_CTL(ch) == false || (ch) == LF || (ch) == CR)
+#define IS_HEX(ch) \
+  (IS_DIGIT(ch) || ((ch) >= 'A' && (ch) <= 'F') || ((ch) >= 'a' && (ch) <= 'f'))
+#define HEX_VALUE(ch) \
+  (IS_DIGIT(ch) ? (ch) - '0' : ((ch) | 0x20) - 'a' + 10)
+
+#define IS_SEPARATOR(ch) (strchr(", /;:=()<>@\"[]?{}\t\\", ch))
+#define IS_SPACE(ch)     ((ch) == ' ' || (ch) == '\t')
+
+/**\brief separator of request line parts, strict policy allows only one space
+ */
+#define IS_LINE_SPACE(ch) (Policy::lenient ? IS_SPACE(ch) : (ch) == SP)
+/**\brief LF without CR is end of line only for lenient policy
+ */
+#define IS_BARE_LF(ch) (Policy::lenient && (ch) == LF)
+
+/**\brief declare view to current token and reset start of token. Token can be
+ * partially saved in spill buffer, so if it can not be completed there, then
+ * parsing will be finished with error
+ */
+#define TAKE_TOKEN(token)                          \
+  std::string_view token;                          \
+  if (take_token(start, iter, token) == false) {   \
+    error_ = parse_error::spill_overflow;          \
+    break;                                         \
+  }                                                \
+  start = NULL;
+
+/**\brief account token of request line and finish parsing with error if the
+ * request line is too long
+ */
+#define CHECK_LINE(token)                                       \
+  line_size_ += (token).size();                                 \
+  if (line_size_ > limits_.request_line) {                      \
+    error_ = parse_error::request_line_too_long;                \
+    break;                                                      \
+  }
+
+/**\brief account header and finish parsing with error if count or size of
+ * headers is too big
+ */
+#define CHECK_HEADER(name, value)                               \
+  header_bytes_ += (name).size() + (value).size();              \
+  if (++headers_count_ > limits_.headers_count) {               \
+    error_ = parse_error::too_many_headers;                     \
+    break;                                                      \
+  } else if (header_bytes_ > limits_.header_bytes) {            \
+    error_ = parse_error::headers_too_large;                    \
+    break;                                                      \
+  }
+
+/**\brief handler can reject the header, in that case parsing is finished with
+ * error. Headers are not reported at all, if policy doesn't capture them
+ */
+#define ON_HEADER(id, name, value)                              \
+  if (Policy::capture_headers &&                                \
+      handler.on_header(id, name, value) == false) {            \
+    error_ = parse_error::rejected_by_handler;                  \
+    break;                                                      \
+  }
+
+namespace http {
+namespace detail {
+inline std::string_view to_view(const char *begin, const char *end) noexcept {
+  return std::string_view{begin, static_cast<size_t>(end - begin)};
+}
+
+/**\return value of leading digits, like atoi, but doesn't need null terminated
+ * string
+ */
+inline size_t to_number(std::string_view str) noexcept {
+  size_t retval = 0;
+  for (char ch : str) {
+    if (IS_DIGIT(ch) == false) {
+      break;
+    }
+    retval = retval * 10 + (ch - '0');
+  }
+  return retval;
+}
+
+/**\brief parse Content-Length value, all octets must be digits
+ * \param out value, or SIZE_MAX if the value doesn't fit in size_t
+ * \return false if value is not a number
+ */
+inline bool to_content_length(std::string_view value, size_t &out) noexcept {
+  if (value.empty()) {
+    return false;
+  }
+
+  uint64_t retval = 0;
+  for (char ch : value) {
+    if (IS_DIGIT(ch) == false) {
+      return false;
+    }
+    uint64_t digit = ch - '0';
+    if (retval > (UINT64_MAX - digit) / 10 || retval * 10 + digit > SIZE_MAX) {
+      out = SIZE_MAX; // overflow
+      return true;
+    }
+    retval = retval * 10 + digit;
+  }
+  out = retval;
+  return true;
+}
+
+/**\return value without trailing not visible octets
+ */
+inline std::string_view trim_value(std::string_view value) noexcept {
+  while (value.empty() == false && IS_VCHAR(value.back()) == false) {
+    value.remove_suffix(1);
+  }
+  return value;
+}
+
+/**\return minor version if octets start by HTTP/1.1 or HTTP/1.0 followed by
+ * CRLF, otherwise -1. Octets must contain at least 10 octets
+ */
+inline int match_version(const char *octets) noexcept {
+  // size is known at compile time, so it is compared as two words
+  if (memcmp(octets, HTTP "/1.1" CRLF, 10) == 0) {
+    return 1;
+  } else if (memcmp(octets, HTTP "/1.0" CRLF, 10) == 0) {
+    return 0;
+  }
+  return -1;
+}
+
+/**\return minor version if octets start by HTTP/1.1 or HTTP/1.0 followed by
+ * SP, as status line of response, otherwise -1. Octets must contain at least 9
+ * octets
+ */
+inline int match_status_version(const char *octets) noexcept {
+  if (memcmp(octets, HTTP "/1.1 ", 9) == 0) {
+    return 1;
+  } else if (memcmp(octets, HTTP "/1.0 ", 9) == 0) {
+    return 0;
+  }
+  return -1;
+}
+
+/**\return true if response doesn't have body regardless of its headers: 1xx,
+ * 204 and 304 responses, response to HEAD and 2xx response to CONNECT
+ * \param method of request, which the response answers
+ */
+inline bool without_body(http::verb method, unsigned status_code) noexcept {
+  return (status_code >= 100 && status_code < 200) || status_code == 204 ||
+         status_code == 304 || method == http::verb::head ||
+         (method == http::verb::connect && status_code / 100 == 2);
+}
+
+/**\brief report status line to response handler, request handlers don't have
+ * on_status, so nothing is called for them
+ */
+template <typename Handler>
+auto on_status(Handler         &handler,
+               unsigned         status_code,
+               std::string_view reason,
+               int /*preferred*/) noexcept
+    -> decltype(handler.on_status(status_code, reason)) {
+  return handler.on_status(status_code, reason);
+}
+
+template <typename Handler>
+void on_status(Handler & /*handler*/,
+               unsigned /*status_code*/,
+               std::string_view /*reason*/,
+               long /*fallback*/) noexcept {
+}
+
+/**\return true if last transfer coding in the value is chunked
+ */
+inline bool is_chunked(std::string_view value) noexcept {
+  size_t comma = value.rfind(',');
+  if (comma != std::string_view::npos) {
+    value.remove_prefix(comma + 1);
+  }
+  while (value.empty() == false && IS_SPACE(value.front())) {
+    value.remove_prefix(1);
+  }
+  return iequals(value, CHUNKED);
+}
+
+/**\return true if comma separated list in the value contains the token
+ */
+inline bool has_token(std::string_view value, std::string_view token) noexcept {
+  for (;;) {
+    size_t           comma = value.find(',');
+    std::string_view item  = value.substr(0, comma);
+    while (item.empty() == false && IS_SPACE(item.front())) {
+      item.remove_prefix(1);
+    }
+    while (item.empty() == false && IS_SPACE(item.back())) {
+      item.remove_suffix(1);
+    }
+    if (iequals(item, token)) {
+      return true;
+    } else if (comma == std::string_view::npos) {
+      return false;
+    }
+    value.remove_prefix(comma + 1);
+  }
+}
+
+/**\return value of the header, which will be added if it doesn't exist
+ */
+inline std::string &header_value(http::headers &headers,
+                                 std::string_view name) {
+  return headers[std::string{name}];
+}
+
+inline std::string &header_value(http::flat_headers &headers,
+                                 std::string_view    name) {
+  return headers[name];
+}
+
+inline std::pmr::string &header_value(http::pmr_headers &headers,
+                                      std::string_view   name) {
+  return headers[std::pmr::string{name, headers.get_allocator()}];
+}
+
+/**\brief add header value to headers. If the header already exists, then
+ * value will be appended with space as separator. Every sequence of not visible
+ * octets inside value will be replaced by one space
+ */
+template <typename Headers>
+void append_header(Headers &headers,
+                   std::string_view name,
+                   std::string_view value) {
+  auto &val = header_value(headers, name);
+  if (value.empty()) {
+    return;
+  }
+
+  val.reserve(val.size() + 1 + value.size());
+  bool separate = val.empty() == false;
+  for (char ch : value) {
+    if (IS_VCHAR(ch)) {
+      if (separate) {
+        val.push_back(SP);
+        separate = false;
+      }
+      val.push_back(ch);
+    } else {
+      separate = true;
+    }
+  }
+}
+
+template <typename Headers>
+class request_builder : public request_handler {
+public:
+  static constexpr bool stop_after_chunk = true;
+
+  /**\brief chunk data is reported only by call, which found it, so previous
+   * chunk is reset
+   */
+  explicit request_builder(http::basic_request<Headers> &req) noexcept
+      : req_{req} {
+    if (req_.chunked) {
+      req_.body      = NULL;
+      req_.body_size = 0;
+    }
+  }
+
+  void on_message_begin() noexcept {
+    req_.chunked   = false;
+    req_.body      = NULL;
+    req_.body_size = 0;
+  }
+
+  void on_method(verb id, std::string_view method) {
+    req_.method    = method;
+    req_.method_id = id;
+  }
+
+  void on_target(std::string_view target) {
+    req_.target = target;
+  }
+
+  void on_version(int major, int minor) noexcept {
+    req_.major = major;
+    req_.minor = minor;
+  }
+
+  bool on_header(field /*id*/, std::string_view name, std::string_view value) {
+    append_header(req_.headers, name, value);
+    return true;
+  }
+
+  void on_headers_complete(size_t content_length,
+                           bool   keep_alive,
+                           bool   chunked) noexcept {
+    req_.content_length = content_length;
+    req_.keep_alive     = keep_alive;
+    req_.chunked        = chunked;
+  }
+
+  /**\brief for not chunked message only first part of body is reported
+   */
+  void on_body(std::string_view data) noexcept {
+    if (req_.chunked || req_.body == NULL) {
+      req_.body      = data.data();
+      req_.body_size = data.size();
+    }
+  }
+
+private:
+  http::basic_request<Headers> &req_;
+};
+
+/**\brief builder of fields, which are same for request_view and response_view
+ * \tparam View message_view or derived one
+ * \tparam Handler base handler of the message
+ */
+template <typename View, typename Handler>
+class message_view_builder : public Handler {
+public:
+  static constexpr bool stop_after_chunk = true;
+
+  explicit message_view_builder(View &msg) noexcept
+      : msg_{msg} {
+    if (msg_.chunked) {
+      msg_.body = std::string_view{};
+    }
+  }
+
+  void on_message_begin() noexcept {
+    // fields of previous message can point to spill, which is cleared now
+    memset(msg_.known_headers, 0, sizeof(msg_.known_headers));
+    msg_.headers_count = 0;
+    msg_.chunked       = false;
+    msg_.body          = std::string_view{};
+  }
+
+  void on_version(int major, int minor) noexcept {
+    msg_.major = major;
+    msg_.minor = minor;
+  }
+
+  bool on_header(field            id,
+                 std::string_view name,
+                 std::string_view value) noexcept {
+    if (msg_.headers_count == message_view::max_headers) {
+      return false;
+    }
+    msg_.headers[msg_.headers_count++] = header_field{name, value};
+
+    unsigned char &index = msg_.known_headers[static_cast<size_t>(id)];
+    if (id != field::unknown && index == 0) {
+      index = msg_.headers_count;
+    }
+    return true;
+  }
+
+  void on_headers_complete(size_t content_length,
+                           bool   keep_alive,
+                           bool   chunked) noexcept {
+    msg_.content_length = content_length;
+    msg_.keep_alive     = keep_alive;
+    msg_.chunked        = chunked;
+  }
+
+  void on_body(std::string_view data) noexcept {
+    msg_.body = data;
+  }
+
+  /**\brief next octets will be in other buffer, so save all parsed headers
+   */
+  bool on_suspend(spill_buffer &spill) noexcept {
+    for (size_t i = 0; i < msg_.headers_count; ++i) {
+      if (spill.save(msg_.headers[i].name) == false ||
+          spill.save(msg_.headers[i].value) == false) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+protected:
+  View &msg_;
+};
+
+class request_view_builder
+    : public message_view_builder<request_view, request_handler> {
+public:
+  using message_view_builder::message_view_builder;
+
+  void on_message_begin() noexcept {
+    message_view_builder::on_message_begin();
+    msg_.method = std::string_view{};
+    msg_.target = std::string_view{};
+  }
+
+  void on_method(verb id, std::string_view method) noexcept {
+    msg_.method    = method;
+    msg_.method_id = id;
+  }
+
+  void on_target(std::string_view target) noexcept {
+    msg_.target = target;
+  }
+
+  /**\brief next octets will be in other buffer, so save all parsed fields
+   */
+  bool on_suspend(spill_buffer &spill) noexcept {
+    return spill.save(msg_.method) && spill.save(msg_.target) &&
+           message_view_builder::on_suspend(spill);
+  }
+};
+
+class lazy_request_view_builder : public request_handler {
+public:
+  static constexpr bool stop_after_chunk = true;
+  static constexpr bool lazy_headers     = true;
+
+  explicit lazy_request_view_builder(http::lazy_request_view &req) noexcept
+      : req_{req} {
+    if (req_.chunked) {
+      req_.body = std::string_view{};
+    }
+  }
+
+  void on_message_begin() noexcept {
+    // fields of previous request can point to spill, which is cleared now
+    req_.method = std::string_view{};
+    req_.target = std::string_view{};
+    memset(req_.known_headers_, 0, sizeof(req_.known_headers_));
+    req_.headers_count_ = 0;
+    req_.indexed_       = true;
+    req_.header_block   = std::string_view{};
+    req_.chunked        = false;
+    req_.body           = std::string_view{};
+  }
+
+  void on_method(verb id, std::string_view method) noexcept {
+    req_.method    = method;
+    req_.method_id = id;
+  }
+
+  void on_target(std::string_view target) noexcept {
+    req_.target = target;
+  }
+
+  void on_version(int major, int minor) noexcept {
+    req_.major = major;
+    req_.minor = minor;
+  }
+
+  bool on_header(field            id,
+                 std::string_view name,
+                 std::string_view value) noexcept {
+    if (req_.headers_count_ == lazy_request_view::max_headers) {
+      return false;
+    }
+    req_.add_header(id, name, value);
+    return true;
+  }
+
+  /**\brief the block is split only at first lookup
+   */
+  bool on_header_block(std::string_view block, size_t count) noexcept {
+    if (req_.headers_count_ + count > lazy_request_view::max_headers) {
+      return false;
+    }
+    req_.header_block = block;
+    req_.indexed_     = false;
+    return true;
+  }
+
+  void on_headers_complete(size_t content_length,
+                           bool   keep_alive,
+                           bool   chunked) noexcept {
+    req_.content_length = content_length;
+    req_.keep_alive     = keep_alive;
+    req_.chunked        = chunked;
+  }
+
+  void on_body(std::string_view data) noexcept {
+    req_.body = data;
+  }
+
+  /**\brief next octets will be in other buffer, so save all parsed fields.
+   * Header block is saved by one copy, so it is still indexed only on demand
+   */
+  bool on_suspend(spill_buffer &spill) noexcept {
+    if (spill.save(req_.method) == false || spill.save(req_.target) == false) {
+      return false;
+    }
+    for (size_t i = 0; i < req_.headers_count_; ++i) {
+      if (spill.save(req_.headers_[i].name) == false ||
+          spill.save(req_.headers_[i].value) == false) {
+        return false;
+      }
+    }
+    return spill.save(req_.header_block);
+  }
+
+private:
+  http::lazy_request_view &req_;
+};
+
+/**\brief used instead of stats::probe, if policy doesn't collect stats, so
+ * it costs nothing
+ */
+struct null_probe {
+  explicit null_probe(stats::phase /*current*/) noexcept {
+  }
+
+  void enter(stats::phase /*next*/) noexcept {
+  }
+
+  void error(size_t /*state*/,
+             stats::octet_class /*octet*/,
+             size_t /*reason*/) noexcept {
+  }
+
+  void request(size_t /*headers_count*/, size_t /*headers_size*/) noexcept {
+  }
+
+  void finish(size_t /*bytes*/) noexcept {
+  }
+};
+} // namespace detail
+
+
+template <typename Headers>
+basic_request<Headers>::basic_request()
+    : method_id{verb::unknown}
+    , major{-1}
+    , minor{-1}
+    , content_length{0}
+    , keep_alive{false}
+    , chunked{false}
+    , body{NULL}
+    , body_size{0} {
+}
+
+template <typename Headers>
+basic_request<Headers>::basic_request(const allocator_type &alloc)
+    : method{alloc}
+    , method_id{verb::unknown}
+    , target{alloc}
+    , major{-1}
+    , minor{-1}
+    , headers{alloc}
+    , content_length{0}
+    , keep_alive{false}
+    , chunked{false}
+    , body{NULL}
+    , body_size{0} {
+}
+
+template <typename Headers>
+basic_request<Headers>::basic_request(const request_view &view)
+    : method{view.method}
+    , method_id{view.method_id}
+    , target{view.target}
+    , major{view.major}
+    , minor{view.minor}
+    , content_length{view.content_length}
+    , keep_alive{view.keep_alive}
+    , chunked{view.chunked}
+    , body{view.body.data()}
+    , body_size{view.body.size()} {
+  for (size_t i = 0; i < view.headers_count; ++i) {
+    detail::append_header(headers, view.headers[i].name, view.headers[i].value);
+  }
+}
+
+template <typename Headers>
+void basic_request<Headers>::reset() noexcept {
+  method.clear();
+  method_id = verb::unknown;
+  target.clear();
+  headers.clear();
+  major          = -1;
+  minor          = -1;
+  content_length = 0;
+  keep_alive     = false;
+  chunked        = false;
+  body           = NULL;
+  body_size      = 0;
+}
+
+
+inline stats::phase request_parser_base::phase_of(int state) noexcept {
+  if (state < cr) {
+    return stats::phase::request_line;
+  } else if (state < body) {
+    return stats::phase::headers;
+  }
+  return stats::phase::body;
+}
+
+template <typename Policy>
+basic_request_parser<Policy>::basic_request_parser(
+    size_t               spill_capacity,
+    const parser_limits &limits) noexcept
+    : request_parser_base{spill_capacity, limits} {
+}
+
+template <typename Policy>
+template <typename Headers>
+request_parser_base::status
+basic_request_parser<Policy>::parse(const void                   *buf,
+                                    size_t                        len,
+                                    http::basic_request<Headers> &req,
+                                    size_t *parsed) noexcept {
+  detail::request_builder<Headers> builder{req};
+  return parse(buf, len, builder, parsed);
+}
+
+template <typename Policy>
+request_parser_base::status
+basic_request_parser<Policy>::parse(const void         *buf,
+                                    size_t              len,
+                                    http::request_view &req,
+                                    size_t             *parsed) noexcept {
+  detail::request_view_builder builder{req};
+  return parse(buf, len, builder, parsed);
+}
+
+template <typename Policy>
+request_parser_base::status
+basic_request_parser<Policy>::parse(const void              *buf,
+                                    size_t                   len,
+                                    http::lazy_request_view &req,
+                                    size_t                  *parsed) noexcept {
+  detail::lazy_request_view_builder builder{req};
+  return parse(buf, len, builder, parsed);
+}
+
+template <typename Policy>
+request_parser_base::batch
+basic_request_parser<Policy>::parse_batch(const void   *buf,
+                                          size_t        len,
+                                          request_view *reqs,
+                                          size_t        count) noexcept {
+  const char *octets  = reinterpret_cast<const char *>(buf);
+  bool        resumed = state_ != 0;
+  batch       retval  = {0, 0, status::in_complete};
+  while (retval.count < count && retval.parsed < len) {
+    detail::request_view_builder builder{reqs[retval.count]};
+    const char                  *begin  = octets + retval.parsed;
+    size_t                       parsed = 0;
+
+    retval.last = parse(begin, len - retval.parsed, builder, &parsed);
+    retval.parsed += parsed;
+    if (retval.last == status::error ||
+        (retval.last & status::in_complete)) {
+      break;
+    }
+
+    ++retval.count;
+    if (resumed) {
+      break;
+    }
+  }
+  return retval;
+}
+
+inline void
+request_parser_base::on_framing_header(field            id,
+                                       std::string_view value) noexcept {
+  switch (id) {
+  case field::content_length: {
+    size_t previous = content_length_; // npos if there is no such header yet
+    if (detail::to_content_length(value, content_length_) == false) {
+      error_ = parse_error::bad_request;
+    } else if (previous != std::string::npos && previous != content_length_) {
+      error_ = parse_error::bad_request; // RFC 9112 6.3, it can be smuggling
+    } else if (content_length_ == std::string::npos ||
+               content_length_ > limits_.body) {
+      error_ = parse_error::body_too_large;
+    }
+  } break;
+  case field::connection: // default of response depends on its version
+    if (detail::has_token(value, CLOSE)) {
+      keep_alive_ = false;
+    } else if (detail::has_token(value, KEEP_ALIVE)) {
+      keep_alive_ = true;
+    }
+    break;
+  case field::transfer_encoding: // codings of all headers make one list
+    transfer_encoding_ = true;
+    chunked_           = detail::is_chunked(value);
+    break;
+  case field::host:
+    ++hosts_;
+    break;
+  default:
+    break;
+  }
+}
+
+inline bool
+request_parser_base::scan_header_block(const scan::kernels &scanner,
+                                       const char          *begin,
+                                       const char          *end) noexcept {
+  for (const char *line = begin; line != end;) {
+    const char *name_end = scanner.header_key(line, end);
+    if (name_end == line || *name_end != COLON) {
+      return false; // multiline value or not valid line
+    }
+    const char *value_end = scanner.header_value(name_end + 1, end);
+    if (value_end == end || *value_end != CR || value_end[1] != LF) {
+      return false; // bare LF, control or not ascii octets
+    }
+
+    std::string_view name  = detail::to_view(line, name_end);
+    std::string_view value = detail::to_view(name_end + 1, value_end);
+    while (value.empty() == false && IS_SPACE(value.front())) {
+      value.remove_prefix(1);
+    }
+    value = detail::trim_value(value);
+
+    header_bytes_ += name.size() + value.size();
+    if (++headers_count_ > limits_.headers_count) {
+      error_ = parse_error::too_many_headers;
+      return false;
+    } else if (header_bytes_ > limits_.header_bytes) {
+      error_ = parse_error::headers_too_large;
+      return false;
+    }
+
+    // only names of framing headers and Host start by these octets
+    char first = detail::to_lower(line[0]);
+    if (first == 'c' || first == 't' || first == 'h') {
+      on_framing_header(to_field(name), value);
+      if (error_ != parse_error::none) {
+        return false;
+      }
+    }
+    line = value_end + 2;
+  }
+  return true;
+}
+
+template <typename Policy>
+template <typename Handler>
+request_parser_base::status
+basic_request_parser<Policy>::parse(const void *buf,
+                                    size_t      len,
+                                    Handler    &handler,
+                                    size_t     *parsed) noexcept {
+  return run<Policy>(buf, len, handler, parsed);
+}
+
+template <typename Policy, typename Handler>
+request_parser_base::status
+request_parser_base::run(const void *buf,
+                         size_t      len,
+                         Handler    &handler,
+                         size_t     *parsed) noexcept {
+  const scan::kernels &scanner = scan::best();
+
+  status      retval = status::error;
+  const char *octets = reinterpret_cast<const char *>(buf);
+  const char *iter   = octets;
+  // not completed token from previous buffer continues from first octet
+  const char *start = token_.empty() ? NULL : octets;
+
+  using probe_type =
+      std::conditional_t<Policy::stats, stats::probe, detail::null_probe>;
+  probe_type probe{phase_of(state_)};
+
+  error_ = parse_error::none;
+  for (; iter != octets + len; ++iter) {
+    char octet = *iter;
+    retval     = status::error;
+    probe.enter(phase_of(state_));
+
+    switch (state_) {
+    case none:
+      state_          = Policy::response ? protocol : verb;
+      header_name_    = std::string_view{};
+      header_field_   = field::unknown;
+      token_          = std::string_view{};
+      start           = NULL;
+      spill_.clear();
+      major_             = -1;
+      content_length_    = std::string::npos;
+      keep_alive_        = false;
+      chunked_           = false;
+      transfer_encoding_ = false;
+      trailers_          = false;
+      hosts_             = 0;
+      body_readed_       = 0;
+      line_size_         = 0;
+      header_bytes_      = 0;
+      headers_count_     = 0;
+      handler.on_message_begin();
+      if (Policy::response) {
+        goto Protocol; // status line starts by version
+      }
+      [[fallthrough]];
+    case verb:
+      if (start == NULL && octets + len - iter >= 8) { // fast path
+        http::verb id = detail::match_verb(iter);
+        if (id != http::verb::unknown) {
+          size_t size = to_string(id).size();
+          line_size_ += size;
+          handler.on_method(id, detail::to_view(iter, iter + size));
+          iter += size; // points to space after method
+          state_ = target;
+          retval = status::in_complete;
+          break;
+        }
+      }
+
+      if (IS_ALPHA(octet)) {
+        if (start == NULL) {
+          start = iter;
+        }
+        retval = status::in_complete;
+      } else if (IS_LINE_SPACE(octet)) {
+        if (start != NULL) {
+          TAKE_TOKEN(method);
+          CHECK_LINE(method);
+          handler.on_method(to_verb(method), method);
+          state_ = target;
+          retval = status::in_complete;
+        }
+      }
+      break;
+    case target:
+      if (start == NULL) {
+        if (octet == SLASH) {
+          state_ = target_origin;
+          goto TargetOrigin;
+        } else if (octet == ASTERISK) {
+          state_ = target_asterisk;
+          retval = status::in_complete;
+        } else if (Policy::absolute_form && IS_ALPHA(octet)) {
+          start  = iter; // absolute or authority
+          retval = status::in_complete;
+        } else if (Policy::lenient && IS_SPACE(octet)) {
+          retval = status::in_complete;
+        }
+      } else { // absolute or authority
+        if (octet == COLON) {
+          state_ = target_colon;
+          retval = status::in_complete;
+        } else if (IS_DIGIT(octet) || octet == DOT || octet == SLASH) {
+          state_ = target_host;
+          goto TargetHost;
+        } else if (IS_ALPHA(octet)) {
+          retval = status::in_complete;
+        }
+      }
+      break;
+    case target_colon:
+      if (octet == SLASH) {
+        state_ = target_scheme;
+        retval = status::in_complete;
+      } else if (IS_VCHAR(octet)) {
+        state_ = target_host;
+        retval = status::in_complete;
+      }
+      break;
+    case target_scheme:
+      if (octet == SLASH) { // second slash, like http://
+        start  = NULL;
+        token_ = std::string_view{};
+        state_ = target_host;
+        retval = status::in_complete;
+      }
+      break;
+    case target_host:
+    TargetHost:
+      if (IS_ALPHA(octet) || IS_DIGIT(octet) || octet == DOT ||
+          octet == COLON) {
+        if (start == NULL) {
+          start = iter;
+        }
+        retval = status::in_complete;
+      } else if (IS_LINE_SPACE(octet)) {
+        if (start != NULL) {
+          TAKE_TOKEN(host);
+          CHECK_LINE(host);
+          ON_HEADER(field::host, to_string(field::host), host);
+          handler.on_target(std::string_view{"/", 1});
+          state_ = protocol;
+          retval = status::in_complete;
+        }
+      } else if (octet == SLASH) {
+        if (start != NULL) {
+          TAKE_TOKEN(host);
+          CHECK_LINE(host);
+          ON_HEADER(field::host, to_string(field::host), host);
+          state_ = target_origin;
+          goto TargetOrigin;
+        }
+      }
+      break;
+    case target_origin:
+    TargetOrigin:
+      if (IS_VCHAR(octet)) {
+        if (start == NULL) {
+          start = iter;
+        }
+        // skip all next visible octets at once
+        iter   = scanner.vchar(iter + 1, octets + len) - 1;
+        retval = status::in_complete;
+      } else if (IS_LINE_SPACE(octet)) {
+        if (start != NULL) {
+          TAKE_TOKEN(target);
+          CHECK_LINE(target);
+          handler.on_target(target);
+          state_ = protocol;
+          retval = status::in_complete;
+        }
+      }
+      break;
+    case target_asterisk:
+      if (IS_LINE_SPACE(octet)) {
+        handler.on_target(std::string_view{"*", 1});
+        state_ = protocol;
+        retval = status::in_complete;
+      }
+      break;
+    case protocol:
+    Protocol:
+      if (Policy::response && start == NULL && octets + len - iter >= 9) {
+        int minor_version = detail::match_status_version(iter);
+        if (minor_version >= 0) { // fast path
+          line_size_ += 8;
+          keep_alive_ = minor_version > 0; // persistent since HTTP/1.1
+          handler.on_version(1, minor_version);
+          iter += 8; // points to space before status code
+          state_ = status_code;
+          retval = status::in_complete;
+          break;
+        }
+      } else if (Policy::response == false && start == NULL &&
+                 octets + len - iter >= 10) { // fast path
+        int minor_version = detail::match_version(iter);
+        if (minor_version >= 0) {
+          handler.on_version(1, minor_version);
+          iter += 9; // points to LF
+          state_ = header_key;
+          retval = status::in_complete;
+          break;
+        }
+      }
+
+      if (IS_ALPHA(octet)) {
+        if (start == NULL) {
+          start = iter;
+        }
+        retval = status::in_complete;
+      } else if (Policy::lenient && IS_SPACE(octet)) {
+        if (start == NULL) {
+          retval = status::in_complete;
+        } else {
+          retval = status::error;
+        }
+      } else if (octet == SLASH) {
+        if (start != NULL) {
+          TAKE_TOKEN(protocol);
+          if (protocol == HTTP) {
+            state_ = major;
+            retval = status::in_complete;
+          }
+        }
+      }
+      break;
+    case major:
+      if (IS_DIGIT(octet)) {
+        if (start == NULL) {
+          start = iter;
+        }
+        retval = status::in_complete;
+      } else if (octet == DOT) {
+        if (start != NULL) {
+          TAKE_TOKEN(major);
+          major_ = detail::to_number(major);
+          state_ = minor;
+          retval = status::in_complete;
+        }
+      }
+      break;
+    case minor:
+      if (IS_DIGIT(octet)) {
+        if (start == NULL) {
+          start = iter;
+        }
+        retval = status::in_complete;
+      } else if (Policy::response) {
+        if (start != NULL && IS_LINE_SPACE(octet)) {
+          TAKE_TOKEN(minor);
+          int minor_version = detail::to_number(minor);
+          keep_alive_       = major_ > 1 || (major_ == 1 && minor_version > 0);
+          handler.on_version(major_, minor_version);
+          state_ = status_code;
+          retval = status::in_complete;
+        }
+      } else if (octet == CR || IS_BARE_LF(octet)) {
+        if (start != NULL) {
+          TAKE_TOKEN(minor);
+          handler.on_version(major_, detail::to_number(minor));
+          if (octet == CR) {
+            state_ = cr;
+          } else {
+            state_ = header_key;
+          }
+          retval = status::in_complete;
+        }
+      }
+      break;
+    case status_code:
+      if (IS_DIGIT(octet)) {
+        if (start == NULL) {
+          start = iter;
+        }
+        retval = status::in_complete;
+      } else if (start == NULL) {
+        if (Policy::lenient && IS_SPACE(octet)) {
+          retval = status::in_complete;
+        }
+      } else if (IS_LINE_SPACE(octet) || octet == CR || IS_BARE_LF(octet)) {
+        TAKE_TOKEN(code);
+        CHECK_LINE(code);
+        if (code.size() != 3) {
+          break;
+        }
+        status_code_ = detail::to_number(code);
+        if (IS_LINE_SPACE(octet)) {
+          state_ = reason;
+          retval = status::in_complete;
+          break;
+        }
+        // reason phrase is empty
+        detail::on_status(handler, status_code_, std::string_view{}, 0);
+        state_ = octet == CR ? cr : header_key;
+        retval = status::in_complete;
+      }
+      break;
+    case reason:
+      if (octet == CR || octet == LF) {
+        if (octet == LF && Policy::lenient == false) {
+          break; // LF without CR
+        }
+
+        std::string_view phrase;
+        if (start != NULL) {
+          TAKE_TOKEN(token);
+          CHECK_LINE(token);
+          phrase = detail::trim_value(token);
+        }
+        detail::on_status(handler, status_code_, phrase, 0);
+        state_ = octet == CR ? cr : header_key;
+        retval = status::in_complete;
+      } else if (start == NULL && IS_SPACE(octet)) {
+        retval = status::in_complete; // leading spaces are not part of reason
+      } else if (IS_TEXT(octet)) {
+        if (start == NULL) {
+          start = iter;
+        }
+        // reason phrase is text of any form, so it is skipped as header value
+        iter   = scanner.header_value(iter + 1, octets + len) - 1;
+        retval = status::in_complete;
+      }
+      break;
+    case cr:
+      if (octet == LF) {
+        state_ = header_key;
+        retval = status::in_complete;
+      }
+      break;
+    case header_key:
+      if ((Handler::lazy_headers || Policy::capture_headers == false) &&
+          start == NULL && headers_count_ == 0 && trailers_ == false &&
+          IS_VCHAR(octet)) {
+        // all headers are in the buffer, so they are reported at once
+        const char *block_end = scanner.header_end(iter, octets + len);
+        if (block_end != octets + len) {
+          if (scan_header_block(scanner, iter, block_end + 2)) {
+            if (Policy::capture_headers &&
+                handler.on_header_block(detail::to_view(iter, block_end + 2),
+                                        headers_count_) == false) {
+              error_ = parse_error::rejected_by_handler;
+              break;
+            }
+            iter = block_end + 3; // points to LF of empty line
+            goto PreBodyLogic;
+          } else if (error_ != parse_error::none) {
+            break;
+          }
+          // lines will be parsed one by one
+          headers_count_ = 0;
+          header_bytes_  = 0;
+          hosts_         = 0;
+        }
+      }
+
+      if (IS_VCHAR(octet)) {
+        if (octet == COLON) {
+          if (start != NULL) {
+            TAKE_TOKEN(name);
+            header_name_  = name;
+            header_field_ = to_field(name);
+            state_       = header_val;
+            retval       = status::in_complete;
+          }
+        } else {
+          if (start == NULL) {
+            start = iter;
+          }
+          iter   = scanner.header_key(iter + 1, octets + len) - 1;
+          retval = status::in_complete;
+        }
+      } else if (start == NULL) {
+        if (Policy::lenient && IS_SPACE(octet)) { // multiline value
+          state_ = header_val;
+          retval = status::in_complete;
+        } else if (octet == CR) {
+          state_ = second_cr;
+          retval = status::in_complete;
+        } else if (IS_BARE_LF(octet)) {
+          goto PreBodyLogic;
+        }
+      }
+      break;
+    case header_val:
+      if (IS_TEXT(octet)) {
+        if (IS_VCHAR(octet)) {
+          if (start == NULL) {
+            start = iter;
+          }
+          // trailing spaces will be trimmed, so we can skip them too
+          iter = scanner.header_value(iter + 1, octets + len) - 1;
+        } else if (octet == CR || octet == LF) {
+          if (octet == LF && Policy::lenient == false) {
+            break; // LF without CR
+          }
+
+          std::string_view value;
+          if (start != NULL) {
+            TAKE_TOKEN(token);
+            value = detail::trim_value(token);
+          }
+
+          // trailers can not change framing of message
+          if (trailers_ == false) {
+            on_framing_header(header_field_, value);
+            if (error_ != parse_error::none) {
+              break;
+            }
+          }
+
+          CHECK_HEADER(header_name_, value);
+          ON_HEADER(header_field_, header_name_, value);
+
+          if (octet == CR) {
+            state_ = cr;
+          } else {
+            state_ = header_key;
+          }
+        }
+        retval = status::in_complete;
+      }
+      break;
+    case second_cr:
+      if (octet == LF) {
+      PreBodyLogic:
+        header_name_ = std::string_view{};
+        if (trailers_) { // end of chunked message
+          handler.on_message_complete();
+          trailers_ = false;
+          state_    = none;
+          retval    = status::done;
+          ++iter;
+          break;
+        } else if (Policy::response == false && transfer_encoding_ &&
+                   (chunked_ == false ||
+                    (Policy::lenient == false &&
+                     content_length_ != std::string::npos))) {
+          break; // body of request can not be framed, RFC 9112 6.3
+        } else if (Policy::response == false && hosts_ > 1) {
+          break; // target can not be identified, RFC 9112 3.2
+        } else if (Policy::response && detail::without_body(
+                                           method_, status_code_)) {
+          if (status_code_ >= 200) { // interim response keeps method
+            method_ = http::verb::unknown;
+          }
+          handler.on_headers_complete(0, keep_alive_, false);
+          handler.on_message_complete();
+          state_ = none;
+          retval = status::done;
+          ++iter;
+          break;
+        } else if (chunked_) { // Content-Length must be ignored
+          handler.on_headers_complete(0, keep_alive_, true);
+          chunk_left_ = 0;
+          state_      = chunk_start;
+          retval      = (status)(status::headers_done | status::in_complete);
+          break;
+        }
+
+        if (Policy::response) { // final response with body
+          method_ = http::verb::unknown;
+        }
+        if (Policy::response && transfer_encoding_) {
+          // other codings are finished by close, RFC 9112 6.3
+          content_length_ = std::string::npos;
+        }
+        if (content_length_ == std::string::npos && Policy::response) {
+          // body is delimited by close of connection, see finish
+          keep_alive_ = false;
+        } else if (content_length_ == std::string::npos &&
+                   !Policy::body_to_end) {
+          content_length_ = 0;
+        } else if (content_length_ == std::string::npos) {
+          content_length_ = (octets + len) - (iter + 1);
+          if (content_length_ > limits_.body) {
+            error_ = parse_error::body_too_large;
+            break;
+          }
+        }
+        handler.on_headers_complete(content_length_, keep_alive_, false);
+
+        if (content_length_ == 0) {
+          handler.on_message_complete();
+          state_ = none;
+          retval = status::done;
+          ++iter;
+        } else {
+          state_ = state::body;
+          retval = (status)(status::headers_done | status::in_complete);
+        }
+      }
+      break;
+    case body: {
+      size_t content_left = content_length_ - body_readed_;
+      size_t buf_left     = octets + len - iter;
+      if (content_left <= buf_left) {
+        handler.on_body(detail::to_view(iter, iter + content_left));
+        body_readed_ += content_left;
+        handler.on_message_complete();
+        state_ = none;
+        retval = status::done;
+        iter += content_left;
+      } else if (content_length_ == std::string::npos &&
+                 buf_left > limits_.body - body_readed_) {
+        error_ = parse_error::body_too_large; // delimited by close
+        break;
+      } else {
+        handler.on_body(detail::to_view(iter, iter + buf_left));
+        body_readed_ += buf_left;
+        state_ = state::body;
+        retval = (status)(status::headers_done | status::in_complete);
+        iter   = octets + len - 1 /*because we increment iter in for loop*/;
+      }
+    } break;
+    case chunk_start: // size must have at least one digit
+      if (IS_HEX(octet) == false) {
+        break;
+      }
+      state_ = chunk_size;
+      [[fallthrough]];
+    case chunk_size:
+      if (IS_HEX(octet)) {
+        if (chunk_left_ > (SIZE_MAX >> 4)) { // overflow
+          error_ = parse_error::body_too_large;
+          break;
+        }
+        chunk_left_ = (chunk_left_ << 4) | HEX_VALUE(octet);
+        retval      = (status)(status::headers_done | status::in_complete);
+        break;
+      }
+      state_ = chunk_bws;
+      [[fallthrough]];
+    case chunk_bws: // only extensions or end of line can follow the size
+      if (octet == ';') {
+        state_ = chunk_ext;
+        retval = (status)(status::headers_done | status::in_complete);
+        break;
+      } else if (Policy::lenient && IS_SPACE(octet)) { // BWS
+        retval = (status)(status::headers_done | status::in_complete);
+        break;
+      } else if (octet != CR && octet != LF) {
+        break;
+      }
+      [[fallthrough]];
+    case chunk_ext: // extensions are ignored
+      if (octet == CR) {
+        state_ = chunk_size_lf;
+        retval = (status)(status::headers_done | status::in_complete);
+        break;
+      } else if (octet != LF) {
+        if (IS_TEXT(octet)) {
+          retval = (status)(status::headers_done | status::in_complete);
+        }
+        break;
+      } else if (Policy::lenient == false) {
+        break; // LF without CR
+      }
+      [[fallthrough]];
+    case chunk_size_lf:
+      if (octet == LF) {
+        if (chunk_left_ == 0) { // last chunk, so trailers are expected
+          trailers_ = true;
+          state_    = header_key;
+        } else if (chunk_left_ > limits_.body - body_readed_) {
+          error_ = parse_error::body_too_large;
+          break;
+        } else {
+          body_readed_ += chunk_left_;
+          state_ = chunk_data;
+        }
+        retval = (status)(status::headers_done | status::in_complete);
+      }
+      break;
+    case chunk_data: {
+      size_t data_size =
+          std::min(chunk_left_, static_cast<size_t>(octets + len - iter));
+      handler.on_body(detail::to_view(iter, iter + data_size));
+      chunk_left_ -= data_size;
+      if (chunk_left_ == 0) {
+        state_ = chunk_data_cr;
+      }
+
+      retval = (status)(status::headers_done | status::in_complete);
+      if (Handler::stop_after_chunk) {
+        // stop parsing, so caller can handle the chunk before next one will
+        // be found
+        iter += data_size;
+        goto Finish;
+      } else {
+        iter += data_size - 1 /*because we increment iter in for loop*/;
+      }
+    } break;
+    case chunk_data_cr:
+      if (octet == CR) {
+        state_ = chunk_data_lf;
+        retval = (status)(status::headers_done | status::in_complete);
+        break;
+      } else if (Policy::lenient == false) {
+        break; // LF without CR
+      }
+      [[fallthrough]];
+    case chunk_data_lf:
+      if (octet == LF) {
+        state_ = chunk_start;
+        retval = (status)(status::headers_done | status::in_complete);
+      }
+      break;
+    default:
+      break;
+    }
+
+    if (retval == status::error) {
+      if (error_ == parse_error::none) {
+        error_ = parse_error::bad_request;
+      }
+      probe.error(state_, stats::classify(octet), static_cast<size_t>(error_));
+      state_ = none;
+      break;
+    } else if ((retval & status::in_complete) == false) {
+      // parsing is done
+      break;
+    }
+  }
+
+Finish:
+  // next octets will be in other buffer, so save all views that will be
+  // needed later: parsed fields, header name (for multiline value) and not
+  // completed token. Stop after chunk is not a suspend, rest of the buffer is
+  // parsed by next call
+  if ((retval & status::in_complete) && iter == octets + len) {
+    // not completed token is checked before it will be saved, so slow request
+    // can not exceed limits
+    size_t pending = token_.size() + (start != NULL ? iter - start : 0);
+    if (state_ < cr && line_size_ + pending > limits_.request_line) {
+      error_ = parse_error::request_line_too_long;
+    } else if (state_ == header_key &&
+               header_bytes_ + pending > limits_.header_bytes) {
+      error_ = parse_error::headers_too_large;
+    } else if (state_ == header_val &&
+               header_bytes_ + header_name_.size() + pending >
+                   limits_.header_bytes) {
+      error_ = parse_error::headers_too_large;
+    } else if (handler.on_suspend(spill_) == false ||
+               spill_.save(header_name_) == false) {
+      error_ = parse_error::spill_overflow;
+    } else if (start != NULL) {
+      if (token_.empty()) {
+        token_ = detail::to_view(start, iter);
+        if (spill_.save(token_) == false) {
+          error_ = parse_error::spill_overflow;
+        }
+      } else if (spill_.extend(token_, detail::to_view(start, iter)) ==
+                 false) {
+        error_ = parse_error::spill_overflow;
+      }
+    }
+
+    if (error_ != parse_error::none) {
+      probe.error(
+          state_, stats::octet_class::none, static_cast<size_t>(error_));
+      retval = status::error;
+      state_ = none;
+    }
+  }
+
+  if (retval == status::done) {
+    probe.request(headers_count_, line_size_ + header_bytes_);
+  }
+  probe.finish(iter - octets);
+
+  if (parsed) {
+    *parsed = iter - octets;
+  }
+  return retval;
+}
+
+} // namespace http
+
+#undef HTTP
+#undef CHUNKED
+#undef KEEP_ALIVE
+#undef CLOSE
+#undef IS_UPALPHA
+#undef IS_LOALPHA
+#undef IS_ALPHA
+#undef IS_DIGIT
+#undef IS_CTL
+#undef IS_VCHAR
+#undef CR
+#undef LF
+#undef CRLF
+#undef SP
+#undef HT
+#undef SLASH
+#undef COLON
+#undef ASTERISK
+#undef DOT
+#undef IS_TEXT
+#undef IS_HEX
+#undef HEX_VALUE
+#undef IS_SEPARATOR
+#undef IS_SPACE
+#undef IS_LINE_SPACE
+#undef IS_BARE_LF
+#undef TAKE_TOKEN
+#undef CHECK_LINE
+#undef CHECK_HEADER
+#undef ON_HEADER
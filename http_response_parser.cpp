@@ -0,0 +1,13 @@
+#include "http_response_parser.hpp"
+
+namespace http {
+response_view::response_view() noexcept
+    : status_code{0} {
+}
+
+void response_view::reset() noexcept {
+  message_view::reset();
+  status_code = 0;
+  reason      = std::string_view{};
+}
+} // namespace http
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "http_request_parser.hpp"
+#include <cstddef>
+#include <string_view>
+
+namespace http {
+/**\brief base class for handlers of response_parser::parse, it has all
+ * callbacks of request_handler, except on_method and on_target, which are
+ * never called for response
+ */
+class response_handler : public request_handler {
+public:
+  /**\brief called after status line
+   * \param reason trimmed reason phrase, it can be empty
+   */
+  void on_status(unsigned /*status_code*/,
+                 std::string_view /*reason*/) noexcept {
+  }
+};
+
+/**\brief non-owning response, same as request_view, but with status line
+ * instead of request line. content_length is SIZE_MAX if body is delimited by
+ * close of connection. Connection is persistent by default since HTTP/1.1,
+ * otherwise only with "Connection: keep-alive"; "close" option always closes
+ * it
+ */
+class response_view : public message_view {
+public:
+  response_view() noexcept;
+
+  /**\brief restore default state
+   */
+  void reset() noexcept;
+
+  unsigned         status_code;
+  std::string_view reason;
+};
+
+namespace detail {
+class response_view_builder
+    : public message_view_builder<response_view, response_handler> {
+public:
+  using message_view_builder::message_view_builder;
+
+  void on_message_begin() noexcept {
+    message_view_builder::on_message_begin();
+    msg_.reason = std::string_view{};
+  }
+
+  void on_status(unsigned status_code, std::string_view reason) noexcept {
+    msg_.status_code = status_code;
+    msg_.reason      = reason;
+  }
+
+  /**\brief next octets will be in other buffer, so save all parsed fields
+   */
+  bool on_suspend(spill_buffer &spill) noexcept {
+    return spill.save(msg_.reason) && message_view_builder::on_suspend(spill);
+  }
+};
+
+/**\brief policy of response parser, all other options are taken from the
+ * policy of request parser
+ */
+template <typename Policy>
+struct response_policy : Policy {
+  static constexpr bool response = true;
+};
+} // namespace detail
+
+/**\brief parser of responses from upstream, it shares the state machine with
+ * request parser, so headers, limits, spill and chunked body are handled in
+ * same way. Body of response is framed by RFC 9112 6.3: 1xx, 204 and 304
+ * responses and responses to HEAD have no body, 2xx response to CONNECT starts
+ * a tunnel, response with Transfer-Encoding, which is not chunked, or without
+ * Content-Length and Transfer-Encoding is finished by close of connection (see
+ * finish)
+ * \tparam Policy compile time options of the parser, body_to_end is ignored
+ * \note 101 response is complete after its headers, next octets belong to the
+ * new protocol
+ */
+template <typename Policy = default_policy>
+class basic_response_parser : public request_parser_base {
+public:
+  using policy_type = detail::response_policy<Policy>;
+
+  explicit basic_response_parser(
+      size_t               spill_capacity = default_spill_capacity,
+      const parser_limits &limits         = parser_limits{}) noexcept;
+
+  /**\brief set method of request, which response will be parsed next, so
+   * response to HEAD or CONNECT is framed properly. Method is kept for 1xx
+   * responses and is reset by final response, clear and resume
+   */
+  void request_method(http::verb method) noexcept;
+
+  /**\brief parse response, fields are saved in the parser, if the status line
+   * or headers are split between buffers
+   * \see basic_request_parser::parse
+   */
+  enum status parse(const void          *buf,
+                    size_t               len,
+                    http::response_view &res,
+                    size_t              *parsed = NULL) noexcept;
+
+  /**\brief parse response and report its parts to the handler
+   * \see response_handler
+   */
+  template <typename Handler>
+  enum status parse(const void *buf,
+                    size_t      len,
+                    Handler    &handler,
+                    size_t     *parsed = NULL) noexcept;
+
+  /**\brief connection is closed by upstream
+   * \return done if the close finishes body of response, error if response is
+   * truncated, in_complete if no response is started
+   */
+  enum status finish() noexcept;
+};
+
+using response_parser        = basic_response_parser<default_policy>;
+using strict_response_parser = basic_response_parser<strict_policy>;
+
+template <typename Policy>
+basic_response_parser<Policy>::basic_response_parser(
+    size_t               spill_capacity,
+    const parser_limits &limits) noexcept
+    : request_parser_base{spill_capacity, limits} {
+}
+
+template <typename Policy>
+void basic_response_parser<Policy>::request_method(http::verb method) noexcept {
+  method_ = method;
+}
+
+template <typename Policy>
+request_parser_base::status
+basic_response_parser<Policy>::parse(const void          *buf,
+                                     size_t               len,
+                                     http::response_view &res,
+                                     size_t              *parsed) noexcept {
+  detail::response_view_builder builder{res};
+  return parse(buf, len, builder, parsed);
+}
+
+template <typename Policy>
+template <typename Handler>
+request_parser_base::status
+basic_response_parser<Policy>::parse(const void *buf,
+                                     size_t      len,
+                                     Handler    &handler,
+                                     size_t     *parsed) noexcept {
+  return run<policy_type>(buf, len, handler, parsed);
+}
+
+template <typename Policy>
+request_parser_base::status basic_response_parser<Policy>::finish() noexcept {
+  if (state_ == none) {
+    return status::in_complete;
+  }
+
+  bool close_delimited =
+      state_ == body && content_length_ == std::string::npos;
+  clear();
+  if (close_delimited == false) {
+    error_ = parse_error::bad_request;
+    return status::error;
+  }
+  return status::done;
+}
+} // namespace http
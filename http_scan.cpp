@@ -0,0 +1,302 @@
+#include "http_scan.hpp"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define HTTP_SCAN_X86
+#  include <immintrin.h>
+#endif
+
+#define IS_VCHAR(ch)        ((ch) >= 33 && (ch) <= 126)
+#define IS_HEADER_KEY(ch)   (IS_VCHAR(ch) && (ch) != ':')
+#define IS_HEADER_VALUE(ch) (IS_VCHAR(ch) || (ch) == ' ' || (ch) == '\t')
+#define IS_URL_PLAIN(ch)    ((ch) != '%' && (ch) != '+')
+
+namespace http {
+namespace scan {
+namespace {
+const char *scalar_vchar(const char *begin, const char *end) noexcept {
+  for (; begin != end && IS_VCHAR(*begin); ++begin) {
+  }
+  return begin;
+}
+
+const char *scalar_header_key(const char *begin, const char *end) noexcept {
+  for (; begin != end && IS_HEADER_KEY(*begin); ++begin) {
+  }
+  return begin;
+}
+
+const char *scalar_header_value(const char *begin, const char *end) noexcept {
+  for (; begin != end && IS_HEADER_VALUE(*begin); ++begin) {
+  }
+  return begin;
+}
+
+const char *scalar_header_end(const char *begin, const char *end) noexcept {
+  while (end - begin >= 4) {
+    const char *cr =
+        static_cast<const char *>(memchr(begin, '\r', end - begin - 3));
+    if (cr == NULL) {
+      break;
+    } else if (cr[1] == '\n' && cr[2] == '\r' && cr[3] == '\n') {
+      return cr;
+    }
+    begin = cr + 1;
+  }
+  return end;
+}
+
+const char *scalar_url_plain(const char *begin, const char *end) noexcept {
+  for (; begin != end && IS_URL_PLAIN(*begin); ++begin) {
+  }
+  return begin;
+}
+
+#ifdef HTTP_SCAN_X86
+/**\brief ranges of allowed octets for pcmpestri, every pair is inclusive range
+ */
+alignas(16) const char vchar_ranges[16]        = "\x21\x7e";
+alignas(16) const char header_key_ranges[16]   = "\x21\x39\x3b\x7e";
+alignas(16) const char header_value_ranges[16] = "\x20\x7e\x09\x09";
+
+template <int RangesLen>
+__attribute__((target("sse4.2"))) inline const char *
+sse42_scan(const char *begin, const char *end, const char *ranges) noexcept {
+  const __m128i allowed =
+      _mm_load_si128(reinterpret_cast<const __m128i *>(ranges));
+  for (; end - begin >= 16; begin += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+    int     index = _mm_cmpestri(allowed,
+                             RangesLen,
+                             chunk,
+                             16,
+                             _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES |
+                                 _SIDD_NEGATIVE_POLARITY |
+                                 _SIDD_LEAST_SIGNIFICANT);
+    if (index != 16) {
+      return begin + index;
+    }
+  }
+  return begin;
+}
+
+__attribute__((target("sse4.2"))) const char *
+sse42_vchar(const char *begin, const char *end) noexcept {
+  return scalar_vchar(sse42_scan<2>(begin, end, vchar_ranges), end);
+}
+
+__attribute__((target("sse4.2"))) const char *
+sse42_header_key(const char *begin, const char *end) noexcept {
+  return scalar_header_key(sse42_scan<4>(begin, end, header_key_ranges), end);
+}
+
+__attribute__((target("sse4.2"))) const char *
+sse42_header_value(const char *begin, const char *end) noexcept {
+  return scalar_header_value(sse42_scan<4>(begin, end, header_value_ranges),
+                             end);
+}
+
+__attribute__((target("sse4.2"))) const char *
+sse42_header_end(const char *begin, const char *end) noexcept {
+  const __m128i crlfcrlf = _mm_setr_epi8(
+      '\r', '\n', '\r', '\n', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  while (end - begin >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+    int     index = _mm_cmpestri(crlfcrlf,
+                             4,
+                             chunk,
+                             16,
+                             _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ORDERED |
+                                 _SIDD_LEAST_SIGNIFICANT);
+    if (index == 16) {
+      begin += 16;
+    } else if (index <= 12) {
+      return begin + index;
+    } else { // sequence can continue in next chunk
+      begin += index;
+    }
+  }
+  return scalar_header_end(begin, end);
+}
+
+__attribute__((target("sse4.2"))) const char *
+sse42_url_plain(const char *begin, const char *end) noexcept {
+  const __m128i escapes = _mm_setr_epi8(
+      '%', '+', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  for (; end - begin >= 16; begin += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+    int     index = _mm_cmpestri(escapes,
+                             2,
+                             chunk,
+                             16,
+                             _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY |
+                                 _SIDD_LEAST_SIGNIFICANT);
+    if (index != 16) {
+      return begin + index;
+    }
+  }
+  return scalar_url_plain(begin, end);
+}
+
+enum octet_class {
+  vchar_class,
+  header_key_class,
+  header_value_class,
+};
+
+/**\return mask of octets in the chunk that belong to the class. Octets greater
+ * then 127 are negative, so they are never visible
+ */
+template <octet_class Class>
+__attribute__((target("avx2"))) inline __m256i
+avx2_mask(__m256i chunk) noexcept {
+  __m256i mask =
+      _mm256_and_si256(_mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(0x20)),
+                       _mm256_cmpgt_epi8(_mm256_set1_epi8(0x7f), chunk));
+  if constexpr (Class == header_key_class) {
+    mask = _mm256_andnot_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(':')),
+                               mask);
+  } else if constexpr (Class == header_value_class) {
+    mask = _mm256_or_si256(
+        mask,
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))));
+  }
+  return mask;
+}
+
+template <octet_class Class>
+__attribute__((target("avx2"))) inline const char *
+avx2_scan(const char *begin, const char *end) noexcept {
+  for (; end - begin >= 32; begin += 32) {
+    __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+    unsigned allowed = _mm256_movemask_epi8(avx2_mask<Class>(chunk));
+    if (allowed != 0xffffffff) {
+      return begin + __builtin_ctz(~allowed);
+    }
+  }
+  return begin;
+}
+
+__attribute__((target("avx2"))) const char *
+avx2_vchar(const char *begin, const char *end) noexcept {
+  return scalar_vchar(avx2_scan<vchar_class>(begin, end), end);
+}
+
+__attribute__((target("avx2"))) const char *
+avx2_header_key(const char *begin, const char *end) noexcept {
+  return scalar_header_key(avx2_scan<header_key_class>(begin, end), end);
+}
+
+__attribute__((target("avx2"))) const char *
+avx2_header_value(const char *begin, const char *end) noexcept {
+  return scalar_header_value(avx2_scan<header_value_class>(begin, end), end);
+}
+
+__attribute__((target("avx2"))) inline __m256i
+avx2_load(const char *begin) noexcept {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+}
+
+/**\brief compares every position with all four octets of CRLFCRLF at once
+ */
+__attribute__((target("avx2"))) const char *
+avx2_header_end(const char *begin, const char *end) noexcept {
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const __m256i lf = _mm256_set1_epi8('\n');
+  for (; end - begin >= 32 + 3; begin += 32) {
+    __m256i first =
+        _mm256_and_si256(_mm256_cmpeq_epi8(avx2_load(begin), cr),
+                         _mm256_cmpeq_epi8(avx2_load(begin + 1), lf));
+    __m256i second =
+        _mm256_and_si256(_mm256_cmpeq_epi8(avx2_load(begin + 2), cr),
+                         _mm256_cmpeq_epi8(avx2_load(begin + 3), lf));
+    unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(first, second));
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  return scalar_header_end(begin, end);
+}
+
+__attribute__((target("avx2"))) const char *
+avx2_url_plain(const char *begin, const char *end) noexcept {
+  const __m256i percent = _mm256_set1_epi8('%');
+  const __m256i plus    = _mm256_set1_epi8('+');
+  for (; end - begin >= 32; begin += 32) {
+    __m256i  chunk = avx2_load(begin);
+    unsigned mask  = _mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, percent),
+                        _mm256_cmpeq_epi8(chunk, plus)));
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  return scalar_url_plain(begin, end);
+}
+#endif
+
+const kernels scalar_kernels = {
+    scalar_vchar,
+    scalar_header_key,
+    scalar_header_value,
+    scalar_header_end,
+    scalar_url_plain,
+};
+
+#ifdef HTTP_SCAN_X86
+const kernels sse42_kernels = {
+    sse42_vchar,
+    sse42_header_key,
+    sse42_header_value,
+    sse42_header_end,
+    sse42_url_plain,
+};
+
+const kernels avx2_kernels = {
+    avx2_vchar,
+    avx2_header_key,
+    avx2_header_value,
+    avx2_header_end,
+    avx2_url_plain,
+};
+#endif
+
+level supported_level() noexcept {
+#ifdef HTTP_SCAN_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return level::avx2;
+  } else if (__builtin_cpu_supports("sse4.2")) {
+    return level::sse42;
+  }
+#endif
+  return level::scalar;
+}
+} // namespace
+
+const kernels &get(level lvl) noexcept {
+  static const level supported = supported_level();
+  if (lvl > supported) {
+    lvl = supported;
+  }
+
+  switch (lvl) {
+#ifdef HTTP_SCAN_X86
+  case level::avx2:
+    return avx2_kernels;
+  case level::sse42:
+    return sse42_kernels;
+#endif
+  default:
+    return scalar_kernels;
+  }
+}
+
+const kernels &best() noexcept {
+  static const kernels &retval = get(level::avx2);
+  return retval;
+}
+} // namespace scan
+} // namespace http
@@ -0,0 +1,46 @@
+#pragma once
+
+namespace http {
+namespace scan {
+enum level {
+  scalar,
+  sse42,
+  avx2,
+};
+
+/**\brief every function returns pointer to first octet in [begin, end) that
+ * doesn't belong to the class, or end if all octets belong to it
+ */
+struct kernels {
+  /**\brief visible chars, used for request target
+   */
+  const char *(*vchar)(const char *begin, const char *end) noexcept;
+
+  /**\brief visible chars except colon, used for header name
+   */
+  const char *(*header_key)(const char *begin, const char *end) noexcept;
+
+  /**\brief visible chars, spaces and tabs, used for header value
+   */
+  const char *(*header_value)(const char *begin, const char *end) noexcept;
+
+  /**\brief unlike others, returns pointer to first CRLFCRLF in [begin, end),
+   * or end if there is no such sequence, used for end of header block
+   */
+  const char *(*header_end)(const char *begin, const char *end) noexcept;
+
+  /**\brief all octets except percent and plus, used for percent decoding
+   */
+  const char *(*url_plain)(const char *begin, const char *end) noexcept;
+};
+
+/**\return kernels for the level, if current cpu doesn't support the level,
+ * then kernels for best supported level will be returned
+ */
+const kernels &get(level lvl) noexcept;
+
+/**\return kernels for best level supported by current cpu
+ */
+const kernels &best() noexcept;
+} // namespace scan
+} // namespace http
@@ -0,0 +1,103 @@
+#include "http_stats.hpp"
+
+namespace http {
+namespace stats {
+namespace {
+/**\brief counters of running thread, which are linked to list of all
+ * running threads
+ */
+struct slot {
+  slot() noexcept;
+  ~slot();
+
+  counters values;
+  slot    *prev;
+  slot    *next;
+};
+
+/**\brief spin lock of the list, it is taken only when thread starts or
+ * finishes and by collect, so parsing threads never wait for it
+ */
+class guard {
+public:
+  guard() noexcept {
+    while (locked.test_and_set(std::memory_order_acquire)) {
+    }
+  }
+
+  ~guard() {
+    locked.clear(std::memory_order_release);
+  }
+
+  guard(const guard &)            = delete;
+  guard &operator=(const guard &) = delete;
+
+private:
+  static std::atomic_flag locked;
+};
+
+std::atomic_flag guard::locked = ATOMIC_FLAG_INIT;
+
+slot *slots = nullptr;
+/**\brief sum of counters of finished threads
+ */
+snapshot retired{};
+
+template <size_t N>
+void sum(uint64_t (&out)[N], const counter (&in)[N]) noexcept {
+  for (size_t i = 0; i < N; ++i) {
+    out[i] += in[i].get();
+  }
+}
+
+void sum(snapshot &out, const counters &values) noexcept {
+  out.bytes += values.bytes.get();
+  out.requests += values.requests.get();
+  sum(out.errors, values.errors);
+  for (size_t i = 0; i < state_count; ++i) {
+    sum(out.error_states[i], values.error_states[i]);
+  }
+  sum(out.headers_count, values.headers_count);
+  sum(out.headers_size, values.headers_size);
+  sum(out.cycles, values.cycles);
+}
+
+slot::slot() noexcept
+    : prev{nullptr} {
+  guard lock;
+  next = slots;
+  if (next != nullptr) {
+    next->prev = this;
+  }
+  slots = this;
+}
+
+slot::~slot() {
+  guard lock;
+  sum(retired, values);
+  if (prev != nullptr) {
+    prev->next = next;
+  } else {
+    slots = next;
+  }
+  if (next != nullptr) {
+    next->prev = prev;
+  }
+}
+} // namespace
+
+counters &local() noexcept {
+  thread_local slot current;
+  return current.values;
+}
+
+snapshot collect() noexcept {
+  guard    lock;
+  snapshot retval = retired;
+  for (const slot *iter = slots; iter != nullptr; iter = iter->next) {
+    sum(retval, iter->values);
+  }
+  return retval;
+}
+} // namespace stats
+} // namespace http
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#endif
+
+namespace http {
+namespace stats {
+/**\brief class of octet, on which parsing failed
+ */
+enum class octet_class : unsigned char {
+  /**\brief error was not caused by octet, for example limit was exceeded at
+   * end of buffer
+   */
+  none,
+  alpha,
+  digit,
+  space,
+  cr,
+  lf,
+  vchar,
+  ctl,
+  not_ascii,
+  count,
+};
+
+enum class phase : unsigned char {
+  request_line,
+  headers,
+  body,
+  count,
+};
+
+constexpr size_t state_count     = 26;
+constexpr size_t error_count     = 8;
+constexpr size_t octet_count     = static_cast<size_t>(octet_class::count);
+constexpr size_t phase_count     = static_cast<size_t>(phase::count);
+constexpr size_t histogram_count = 16;
+
+/**\brief sum of counters of all threads
+ */
+struct snapshot {
+  uint64_t bytes;
+  uint64_t requests;
+  /**\brief errors by parse_error
+   */
+  uint64_t errors[error_count];
+  /**\brief errors by state of parser and class of octet, on which parsing
+   * failed
+   */
+  uint64_t error_states[state_count][octet_count];
+  /**\brief bucket i counts requests with count of headers in [2^(i-1), 2^i),
+   * bucket 0 counts requests without headers, last bucket counts all greater
+   */
+  uint64_t headers_count[histogram_count];
+  /**\brief same as headers_count, but for size of request line and headers
+   */
+  uint64_t headers_size[histogram_count];
+  /**\brief cycles (or nanoseconds, if cycle counter is not available) spent
+   * in every phase
+   */
+  uint64_t cycles[phase_count];
+};
+
+/**\brief counter, that is updated only by its thread, so it doesn't need
+ * atomic increment, but it can be read by any thread
+ */
+class counter {
+public:
+  void add(uint64_t value) noexcept {
+    value_.store(value_.load(std::memory_order_relaxed) + value,
+                 std::memory_order_relaxed);
+  }
+
+  uint64_t get() const noexcept {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint64_t> value_{0};
+};
+
+/**\brief counters of one thread
+ */
+struct counters {
+  counter bytes;
+  counter requests;
+  counter errors[error_count];
+  counter error_states[state_count][octet_count];
+  counter headers_count[histogram_count];
+  counter headers_size[histogram_count];
+  counter cycles[phase_count];
+};
+
+/**\return counters of current thread, they are kept in thread local storage
+ * and are not allocated. When thread is finished its counters are added to
+ * sum of finished threads, so collected values only grow
+ */
+counters &local() noexcept;
+
+/**\return sum of counters of all threads, it doesn't block parsing threads
+ */
+snapshot collect() noexcept;
+
+inline uint64_t cycles() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+inline octet_class classify(char ch) noexcept {
+  if ((ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z')) {
+    return octet_class::alpha;
+  } else if (ch >= '0' && ch <= '9') {
+    return octet_class::digit;
+  } else if (ch == ' ' || ch == '\t') {
+    return octet_class::space;
+  } else if (ch == '\r') {
+    return octet_class::cr;
+  } else if (ch == '\n') {
+    return octet_class::lf;
+  } else if (ch >= 33 && ch <= 126) {
+    return octet_class::vchar;
+  } else if (static_cast<unsigned char>(ch) > 127) {
+    return octet_class::not_ascii;
+  }
+  return octet_class::ctl;
+}
+
+/**\return index of histogram bucket for the value
+ */
+inline size_t bucket(uint64_t value) noexcept {
+  size_t retval = value == 0 ? 0 : 64 - __builtin_clzll(value);
+  return retval < histogram_count ? retval : histogram_count - 1;
+}
+
+/**\brief collects counters of one parse call, so counters of thread are
+ * updated only once per call
+ */
+class probe {
+public:
+  explicit probe(phase current) noexcept
+      : counters_{local()}
+      , phase_{current}
+      , mark_{cycles()} {
+  }
+
+  /**\brief account cycles of previous phase, if phase was changed
+   */
+  void enter(phase next) noexcept {
+    if (next != phase_) {
+      uint64_t now = cycles();
+      counters_.cycles[static_cast<size_t>(phase_)].add(now - mark_);
+      phase_ = next;
+      mark_  = now;
+    }
+  }
+
+  void error(size_t state, octet_class octet, size_t reason) noexcept {
+    counters_.errors[reason].add(1);
+    counters_.error_states[state][static_cast<size_t>(octet)].add(1);
+  }
+
+  void request(size_t headers_count, size_t headers_size) noexcept {
+    counters_.requests.add(1);
+    counters_.headers_count[bucket(headers_count)].add(1);
+    counters_.headers_size[bucket(headers_size)].add(1);
+  }
+
+  void finish(size_t bytes) noexcept {
+    counters_.bytes.add(bytes);
+    counters_.cycles[static_cast<size_t>(phase_)].add(cycles() - mark_);
+  }
+
+private:
+  counters &counters_;
+  phase     phase_;
+  uint64_t  mark_;
+};
+} // namespace stats
+} // namespace http
@@ -0,0 +1,168 @@
+#include "http_target.hpp"
+#include "http_scan.hpp"
+#include <cstring>
+
+#define IS_DIGIT(ch) ((ch) >= '0' && (ch) <= '9')
+#define IS_HEX(ch) \
+  (IS_DIGIT(ch) || ((ch) >= 'A' && (ch) <= 'F') || ((ch) >= 'a' && (ch) <= 'f'))
+#define HEX_VALUE(ch) \
+  (IS_DIGIT(ch) ? (ch) - '0' : ((ch) | 0x20) - 'a' + 10)
+
+namespace http {
+size_t percent_decode(std::string_view src,
+                      char            *out,
+                      bool             plus_as_space) noexcept {
+  const scan::kernels &scanner = scan::best();
+
+  const char *iter = src.data();
+  const char *end  = src.data() + src.size();
+  char       *dest = out;
+  while (iter != end) {
+    // copy all octets before next escape at once
+    const char *plain = scanner.url_plain(iter, end);
+    if (dest != iter) {
+      memmove(dest, iter, plain - iter);
+    }
+    dest += plain - iter;
+    iter = plain;
+
+    if (iter == end) {
+      break;
+    } else if (*iter == '+') {
+      *dest++ = plus_as_space ? ' ' : '+';
+      iter += 1;
+    } else if (end - iter < 3 || IS_HEX(iter[1]) == false ||
+               IS_HEX(iter[2]) == false) {
+      return std::string_view::npos;
+    } else {
+      *dest++ = static_cast<char>(HEX_VALUE(iter[1]) << 4 | HEX_VALUE(iter[2]));
+      iter += 3;
+    }
+  }
+  return dest - out;
+}
+
+
+target_view::target_view() noexcept
+    : segments_count_{0}
+    , params_count_{0}
+    , truncated_{false}
+    , indexed_{true} {
+}
+
+target_view::target_view(std::string_view target) noexcept
+    : target_{target}
+    , segments_count_{0}
+    , params_count_{0}
+    , truncated_{false}
+    , indexed_{false} {
+  std::string_view rest = target;
+
+  // absolute form, scheme and authority are skipped
+  size_t scheme = rest.find("://");
+  if (rest.empty() == false && rest.front() != '/' &&
+      scheme != std::string_view::npos) {
+    rest.remove_prefix(scheme + 3);
+    size_t authority = rest.find_first_of("/?#");
+    rest.remove_prefix(authority == std::string_view::npos ? rest.size()
+                                                           : authority);
+  }
+
+  size_t fragment = rest.find('#');
+  if (fragment != std::string_view::npos) {
+    rest = rest.substr(0, fragment);
+  }
+
+  size_t question = rest.find('?');
+  if (question != std::string_view::npos) {
+    query_ = rest.substr(question + 1);
+    rest   = rest.substr(0, question);
+  }
+  path_ = rest;
+}
+
+std::string_view target_view::target() const noexcept {
+  return target_;
+}
+
+std::string_view target_view::path() const noexcept {
+  return path_;
+}
+
+std::string_view target_view::query() const noexcept {
+  return query_;
+}
+
+size_t target_view::segments_count() const noexcept {
+  index();
+  return segments_count_;
+}
+
+std::string_view target_view::segment(size_t index) const noexcept {
+  this->index();
+  return segments_[index];
+}
+
+size_t target_view::params_count() const noexcept {
+  index();
+  return params_count_;
+}
+
+const query_param &target_view::param(size_t index) const noexcept {
+  this->index();
+  return params_[index];
+}
+
+std::string_view target_view::param(std::string_view key) const noexcept {
+  index();
+  for (size_t i = 0; i < params_count_; ++i) {
+    if (params_[i].key == key) {
+      return params_[i].value;
+    }
+  }
+  return std::string_view{};
+}
+
+bool target_view::truncated() const noexcept {
+  index();
+  return truncated_;
+}
+
+void target_view::index() const noexcept {
+  if (indexed_) {
+    return;
+  }
+  indexed_ = true;
+
+  for (size_t slash = path_.find('/'); slash != std::string_view::npos;) {
+    size_t next = path_.find('/', slash + 1);
+    if (segments_count_ == max_segments) {
+      truncated_ = true;
+      break;
+    }
+    segments_[segments_count_++] = path_.substr(slash + 1, next - slash - 1);
+    slash                        = next;
+  }
+
+  std::string_view rest = query_;
+  while (rest.empty() == false) {
+    size_t           amp  = rest.find('&');
+    std::string_view pair = rest.substr(0, amp);
+    rest.remove_prefix(amp == std::string_view::npos ? rest.size() : amp + 1);
+    if (pair.empty()) {
+      continue;
+    } else if (params_count_ == max_params) {
+      truncated_ = true;
+      break;
+    }
+
+    size_t equal = pair.find('=');
+    if (equal == std::string_view::npos) {
+      params_[params_count_++] = query_param{pair, std::string_view{}};
+    } else {
+      params_[params_count_++] =
+          query_param{pair.substr(0, equal), pair.substr(equal + 1)};
+    }
+  }
+}
+} // namespace http
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace http {
+/**\brief decode percent encoded octets of path or query
+ * \param out buffer for at least src.size() octets, it can be src.data(), so
+ * the source is decoded in place
+ * \param plus_as_space if true, then plus is decoded as space, as it is done
+ * for query of html form
+ * \return size of decoded octets, or std::string_view::npos if percent is not
+ * followed by two hex digits
+ */
+size_t percent_decode(std::string_view src,
+                      char *           out,
+                      bool             plus_as_space = false) noexcept;
+
+struct query_param {
+  std::string_view key;
+  std::string_view value;
+};
+
+/**\brief index of request target: path segments and query parameters. Index
+ * is built at first access to segments or parameters, it doesn't allocate any
+ * memory and all views point to the target, so they are still encoded
+ * \note absolute form is also supported, scheme and authority are skipped
+ */
+class target_view {
+public:
+  static constexpr size_t max_segments = 32;
+  static constexpr size_t max_params   = 32;
+
+  target_view() noexcept;
+  explicit target_view(std::string_view target) noexcept;
+
+  std::string_view target() const noexcept;
+
+  /**\return path without query and fragment
+   */
+  std::string_view path() const noexcept;
+
+  /**\return query without question mark, or empty view
+   */
+  std::string_view query() const noexcept;
+
+  /**\brief every slash of path starts a segment, so "/" has one empty segment
+   */
+  size_t           segments_count() const noexcept;
+  std::string_view segment(size_t index) const noexcept;
+
+  /**\brief parameters are separated by ampersand, parameter without equal sign
+   * has empty value, empty parameters are skipped
+   */
+  size_t             params_count() const noexcept;
+  const query_param &param(size_t index) const noexcept;
+
+  /**\return value of first parameter with the key, key is compared as is,
+   * without decoding, or empty view if there is no such parameter
+   */
+  std::string_view param(std::string_view key) const noexcept;
+
+  /**\return true if path or query contains more items then index can hold,
+   * in that case only first items are indexed
+   */
+  bool truncated() const noexcept;
+
+private:
+  void index() const noexcept;
+
+  std::string_view target_;
+  std::string_view path_;
+  std::string_view query_;
+
+  mutable std::string_view segments_[max_segments];
+  mutable query_param      params_[max_params];
+  mutable size_t           segments_count_;
+  mutable size_t           params_count_;
+  mutable bool             truncated_;
+  mutable bool             indexed_;
+};
+} // namespace http
@@ -0,0 +1,261 @@
+#include "http_uring.hpp"
+
+#ifdef __linux__
+#  include <algorithm>
+#  include <cerrno>
+#  include <sys/mman.h>
+#  include <sys/socket.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+
+namespace http {
+namespace {
+/**\brief group of provided buffers, the ring has only one group
+ */
+constexpr uint16_t buffer_group = 0;
+
+template <typename T>
+T *at(void *base, size_t offset) noexcept {
+  return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+
+void *map(size_t size, int fd, off_t offset) noexcept {
+  void *retval = mmap(NULL,
+                      size,
+                      PROT_READ | PROT_WRITE,
+                      fd == -1 ? MAP_PRIVATE | MAP_ANONYMOUS
+                               : MAP_SHARED | MAP_POPULATE,
+                      fd,
+                      offset);
+  return retval == MAP_FAILED ? nullptr : retval;
+}
+} // namespace
+
+uring::uring(unsigned entries,
+             unsigned buffers,
+             unsigned buffer_size) noexcept
+    : fd_{-1}
+    , rings_{nullptr}
+    , rings_size_{0}
+    , sqes_{nullptr}
+    , sqes_size_{0}
+    , queued_{0}
+    , buf_ring_{nullptr}
+    , buf_tail_{nullptr}
+    , buf_ring_size_{0}
+    , buffers_{nullptr}
+    , buffers_count_{buffers}
+    , buffer_size_{buffer_size} {
+  io_uring_params params{};
+  params.flags      = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER |
+                      IORING_SETUP_DEFER_TASKRUN;
+  params.cq_entries = entries * 2;
+  fd_               = syscall(__NR_io_uring_setup, entries, &params);
+  if (fd_ < 0 && errno == EINVAL) { // kernel before 6.1
+    params            = io_uring_params{};
+    params.flags      = IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 2;
+    fd_               = syscall(__NR_io_uring_setup, entries, &params);
+  }
+  if (fd_ < 0) {
+    return;
+  }
+
+  // both rings are in one mapping since linux 5.4
+  rings_size_    = std::max(
+      params.sq_off.array + params.sq_entries * sizeof(unsigned),
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+  rings_         = map(rings_size_, fd_, IORING_OFF_SQ_RING);
+  sqes_size_     = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_          = static_cast<io_uring_sqe *>(
+      map(sqes_size_, fd_, IORING_OFF_SQES));
+  buf_ring_size_ = buffers * sizeof(io_uring_buf);
+  buf_ring_      = static_cast<io_uring_buf *>(map(buf_ring_size_, -1, 0));
+  buffers_       = static_cast<char *>(
+      map(size_t{buffers} * buffer_size, -1, 0));
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0 || rings_ == nullptr ||
+      sqes_ == nullptr || buf_ring_ == nullptr || buffers_ == nullptr) {
+    errno = ENOSYS;
+    close(fd_);
+    fd_ = -1;
+    return;
+  }
+
+  sq_head_  = at<unsigned>(rings_, params.sq_off.head);
+  sq_tail_  = at<unsigned>(rings_, params.sq_off.tail);
+  sq_mask_  = *at<unsigned>(rings_, params.sq_off.ring_mask);
+  cq_head_  = at<unsigned>(rings_, params.cq_off.head);
+  cq_tail_  = at<unsigned>(rings_, params.cq_off.tail);
+  cq_mask_  = *at<unsigned>(rings_, params.cq_off.ring_mask);
+  cqes_     = at<io_uring_cqe>(rings_, params.cq_off.cqes);
+  buf_tail_ = &reinterpret_cast<io_uring_buf_ring *>(buf_ring_)->tail;
+
+  // entries of submission queue are used in order
+  unsigned *array = at<unsigned>(rings_, params.sq_off.array);
+  for (unsigned i = 0; i < params.sq_entries; ++i) {
+    array[i] = i;
+  }
+
+  io_uring_buf_reg reg{};
+  reg.ring_addr    = reinterpret_cast<uint64_t>(buf_ring_);
+  reg.ring_entries = buffers;
+  reg.bgid         = buffer_group;
+  if (syscall(__NR_io_uring_register,
+              fd_,
+              IORING_REGISTER_PBUF_RING,
+              &reg,
+              1) != 0) {
+    close(fd_);
+    fd_ = -1;
+    return;
+  }
+  for (unsigned i = 0; i < buffers; ++i) {
+    io_uring_buf &buf = buf_ring_[i];
+    buf.addr          = reinterpret_cast<uint64_t>(buffers_ + i * buffer_size);
+    buf.len           = buffer_size;
+    buf.bid           = i;
+  }
+  __atomic_store_n(buf_tail_, buffers, __ATOMIC_RELEASE);
+}
+
+uring::~uring() {
+  if (fd_ != -1) {
+    close(fd_);
+  }
+  if (rings_ != nullptr) {
+    munmap(rings_, rings_size_);
+  }
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (buf_ring_ != nullptr) {
+    munmap(buf_ring_, buf_ring_size_);
+  }
+  if (buffers_ != nullptr) {
+    munmap(buffers_, size_t{buffers_count_} * buffer_size_);
+  }
+}
+
+bool uring::valid() const noexcept {
+  return fd_ != -1;
+}
+
+bool uring::accept(int listener, uint64_t user_data) noexcept {
+  io_uring_sqe *sqe = next();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode       = IORING_OP_ACCEPT;
+  sqe->fd           = listener;
+  sqe->ioprio       = IORING_ACCEPT_MULTISHOT;
+  sqe->accept_flags = SOCK_CLOEXEC;
+  sqe->user_data    = user_data;
+  return true;
+}
+
+bool uring::receive(int fd, uint64_t user_data) noexcept {
+  io_uring_sqe *sqe = next();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode    = IORING_OP_RECV;
+  sqe->fd        = fd;
+  sqe->ioprio    = IORING_RECV_MULTISHOT;
+  sqe->flags     = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = buffer_group;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool uring::send(int         fd,
+                 const void *data,
+                 size_t      size,
+                 uint64_t    user_data) noexcept {
+  io_uring_sqe *sqe = next();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode    = IORING_OP_SEND;
+  sqe->fd        = fd;
+  sqe->addr      = reinterpret_cast<uint64_t>(data);
+  sqe->len       = size;
+  sqe->msg_flags = MSG_NOSIGNAL;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool uring::submit_and_wait() noexcept {
+  for (;;) {
+    int submitted = enter(queued_, 1);
+    if (submitted >= 0) {
+      queued_ -= submitted;
+      return true;
+    } else if (errno != EINTR) {
+      return false;
+    }
+  }
+}
+
+const io_uring_cqe *uring::peek() const noexcept {
+  unsigned head = *cq_head_;
+  if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+    return nullptr;
+  }
+  return &cqes_[head & cq_mask_];
+}
+
+void uring::pop() noexcept {
+  __atomic_store_n(cq_head_, *cq_head_ + 1, __ATOMIC_RELEASE);
+}
+
+std::string_view uring::buffer(const io_uring_cqe &cqe) const noexcept {
+  if ((cqe.flags & IORING_CQE_F_BUFFER) == 0 || cqe.res <= 0) {
+    return std::string_view{};
+  }
+  unsigned id = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+  return std::string_view{buffers_ + size_t{id} * buffer_size_,
+                          static_cast<size_t>(cqe.res)};
+}
+
+void uring::recycle(const io_uring_cqe &cqe) noexcept {
+  if ((cqe.flags & IORING_CQE_F_BUFFER) == 0) {
+    return;
+  }
+  // only this thread adds buffers, so tail can be read without barrier
+  uint16_t      id   = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+  uint16_t      tail = *buf_tail_;
+  io_uring_buf &buf  = buf_ring_[tail & (buffers_count_ - 1)];
+  buf.addr           = reinterpret_cast<uint64_t>(buffers_ + id * buffer_size_);
+  buf.len            = buffer_size_;
+  buf.bid            = id;
+  __atomic_store_n(buf_tail_, tail + 1, __ATOMIC_RELEASE);
+}
+
+io_uring_sqe *uring::next() noexcept {
+  unsigned tail = *sq_tail_;
+  if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) > sq_mask_) {
+    int submitted = enter(queued_, 0);
+    if (submitted <= 0) {
+      return nullptr;
+    }
+    queued_ -= submitted;
+  }
+
+  io_uring_sqe *retval = &sqes_[tail & sq_mask_];
+  *retval              = io_uring_sqe{};
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  ++queued_;
+  return retval;
+}
+
+int uring::enter(unsigned submit, unsigned wait) noexcept {
+  return syscall(__NR_io_uring_enter,
+                 fd_,
+                 submit,
+                 wait,
+                 wait != 0 ? IORING_ENTER_GETEVENTS : 0,
+                 NULL,
+                 0);
+}
+} // namespace http
+#endif
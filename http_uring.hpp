@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#ifdef __linux__
+#  include <linux/io_uring.h>
+#endif
+
+namespace http {
+#ifdef __linux__
+/**\brief minimal io_uring front end without liburing: submission and
+ * completion rings and one ring of provided buffers. Multishot receive picks
+ * buffer from the ring, so completed read can be parsed directly from it
+ * without copying to buffer of connection
+ * \note requires linux 6.0 (multishot receive and ring of provided buffers)
+ * \note buffer of completion is valid until it is recycled, so parsed request
+ * must be saved before (request_parser saves fields of incomplete request by
+ * request_handler::on_suspend), body must be consumed before too
+ */
+class uring {
+public:
+  /**\param entries size of submission queue, completion queue is twice
+   * larger
+   * \param buffers count of provided buffers, must be power of 2
+   * \param buffer_size size of every provided buffer
+   */
+  uring(unsigned entries, unsigned buffers, unsigned buffer_size) noexcept;
+  ~uring();
+
+  uring(const uring &)            = delete;
+  uring &operator=(const uring &) = delete;
+
+  /**\return false if kernel doesn't support io_uring or its features, errno
+   * is set
+   */
+  bool valid() const noexcept;
+
+  /**\brief start multishot accept, every accepted socket is reported by its
+   * own completion
+   */
+  bool accept(int listener, uint64_t user_data) noexcept;
+
+  /**\brief start multishot receive to provided buffers. Receive is stopped
+   * (completion doesn't have IORING_CQE_F_MORE flag) on error, end of stream
+   * or when ring of buffers is empty (-ENOBUFS), then it must be restarted
+   */
+  bool receive(int fd, uint64_t user_data) noexcept;
+
+  bool send(int fd, const void *data, size_t size, uint64_t user_data) noexcept;
+
+  /**\brief submit queued operations and wait for at least one completion
+   * \return false on error, errno is set
+   */
+  bool submit_and_wait() noexcept;
+
+  /**\return next completion or nullptr, completion must be released by
+   * pop before next call
+   */
+  const io_uring_cqe *peek() const noexcept;
+
+  void pop() noexcept;
+
+  /**\return received data, if the completion holds provided buffer
+   */
+  std::string_view buffer(const io_uring_cqe &cqe) const noexcept;
+
+  /**\brief return buffer of the completion to the ring
+   */
+  void recycle(const io_uring_cqe &cqe) noexcept;
+
+private:
+  /**\return free entry of submission queue, queue is submitted if it is full
+   */
+  io_uring_sqe *next() noexcept;
+
+  int enter(unsigned submit, unsigned wait) noexcept;
+
+  int fd_;
+
+  void  *rings_;
+  size_t rings_size_;
+
+  io_uring_sqe *sqes_;
+  size_t        sqes_size_;
+  unsigned     *sq_head_;
+  unsigned     *sq_tail_;
+  unsigned      sq_mask_;
+  /**\brief count of entries, that are queued, but not submitted
+   */
+  unsigned queued_;
+
+  unsigned     *cq_head_;
+  unsigned     *cq_tail_;
+  unsigned      cq_mask_;
+  io_uring_cqe *cqes_;
+
+  /**\brief entries of io_uring_buf_ring, its bufs can't be used in c++,
+   * because empty struct before them has non zero size
+   */
+  io_uring_buf *buf_ring_;
+  uint16_t     *buf_tail_;
+  size_t        buf_ring_size_;
+  char         *buffers_;
+  unsigned      buffers_count_;
+  unsigned      buffer_size_;
+};
+#endif
+} // namespace http
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+namespace http {
+/**\brief well known request methods
+ */
+enum class verb : unsigned char {
+  unknown,
+  get,
+  head,
+  post,
+  put,
+  delete_,
+  connect,
+  options,
+  trace,
+  patch,
+  count,
+};
+
+namespace detail {
+constexpr std::string_view verb_names[static_cast<size_t>(verb::count)] = {
+    "",
+    "GET",
+    "HEAD",
+    "POST",
+    "PUT",
+    "DELETE",
+    "CONNECT",
+    "OPTIONS",
+    "TRACE",
+    "PATCH",
+};
+
+/**\return true if the octets start by the method and a space after it
+ */
+template <size_t N>
+inline bool starts_with(const char *octets, const char (&method)[N]) noexcept {
+  // size is known at compile time, so it is compared as one or two words
+  return memcmp(octets, method, N - 1) == 0;
+}
+
+/**\brief match method of request line by a few word compares
+ * \param octets must contain at least 8 octets
+ * \return well known method, if it is followed by space, or verb::unknown
+ */
+inline verb match_verb(const char *octets) noexcept {
+  switch (octets[0]) {
+  case 'G':
+    return starts_with(octets, "GET ") ? verb::get : verb::unknown;
+  case 'H':
+    return starts_with(octets, "HEAD ") ? verb::head : verb::unknown;
+  case 'P':
+    if (starts_with(octets, "POST ")) {
+      return verb::post;
+    } else if (starts_with(octets, "PUT ")) {
+      return verb::put;
+    } else if (starts_with(octets, "PATCH ")) {
+      return verb::patch;
+    }
+    return verb::unknown;
+  case 'D':
+    return starts_with(octets, "DELETE ") ? verb::delete_ : verb::unknown;
+  case 'C':
+    return starts_with(octets, "CONNECT ") ? verb::connect : verb::unknown;
+  case 'O':
+    return starts_with(octets, "OPTIONS ") ? verb::options : verb::unknown;
+  case 'T':
+    return starts_with(octets, "TRACE ") ? verb::trace : verb::unknown;
+  default:
+    return verb::unknown;
+  }
+}
+} // namespace detail
+
+/**\return well known method (case sensetive), or verb::unknown
+ */
+constexpr verb to_verb(std::string_view method) noexcept {
+  for (size_t i = 1; i < static_cast<size_t>(verb::count); ++i) {
+    if (detail::verb_names[i] == method) {
+      return static_cast<verb>(i);
+    }
+  }
+  return verb::unknown;
+}
+
+/**\return name of the method, or empty view for verb::unknown
+ */
+constexpr std::string_view to_string(verb id) noexcept {
+  return detail::verb_names[static_cast<size_t>(id)];
+}
+
+static_assert(to_verb("OPTIONS") == verb::options,
+              "invalid names of methods");
+static_assert(to_verb("get") == verb::unknown, "invalid names of methods");
+} // namespace http
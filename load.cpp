@@ -0,0 +1,269 @@
+// local load generator for the reference server: every thread keeps its
+// connections busy with pipelined requests and records latency of every
+// response
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#define REQUEST                                                               \
+  "GET /plaintext HTTP/1.1\r\n"                                               \
+  "Host: localhost\r\n"                                                       \
+  "User-Agent: load\r\n"                                                      \
+  "Accept: */*\r\n"                                                           \
+  "\r\n"
+#define READ_BUFFER_SIZE (64 * 1024)
+#define MAX_EVENTS       256
+
+namespace {
+using clock_type = std::chrono::steady_clock;
+
+struct connection {
+  int fd = -1;
+  /**\brief send time of every request in current pipeline
+   */
+  std::vector<clock_type::time_point> sent;
+  size_t                              answered = 0;
+  /**\brief unparsed part of responses
+   */
+  std::string in;
+};
+
+struct result {
+  uint64_t requests = 0;
+  uint64_t errors   = 0;
+  /**\brief latency of every response in microseconds
+   */
+  std::vector<uint32_t> latencies;
+};
+
+/**\return size of first complete response in the data, 0 if the response is
+ * incomplete, or npos if the response is invalid
+ */
+size_t response_size(std::string_view data) noexcept {
+  size_t end = data.find("\r\n\r\n");
+  if (end == std::string_view::npos) {
+    return 0;
+  } else if (data.compare(0, 9, "HTTP/1.1 ") != 0) {
+    return std::string_view::npos;
+  }
+
+  size_t length = 0;
+  size_t pos    = data.find("Content-Length: ");
+  if (pos < end) {
+    length = strtoul(data.data() + pos + 16, NULL, 10);
+  }
+  size_t retval = end + 4 + length;
+  return retval <= data.size() ? retval : 0;
+}
+
+int connect_to(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return -1;
+  }
+
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  int on = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+  return fd;
+}
+
+class client {
+public:
+  client(const std::string &pipeline, size_t depth) noexcept
+      : pipeline_{pipeline}
+      , depth_{depth}
+      , epoll_{epoll_create1(EPOLL_CLOEXEC)} {
+  }
+
+  ~client() {
+    for (connection &conn : connections_) {
+      if (conn.fd != -1) {
+        close(conn.fd);
+      }
+    }
+    close(epoll_);
+  }
+
+  bool open(uint16_t port, size_t count) {
+    connections_.resize(count);
+    for (connection &conn : connections_) {
+      conn.fd = connect_to(port);
+      if (conn.fd < 0) {
+        return false;
+      }
+      conn.sent.resize(depth_);
+
+      epoll_event event{};
+      event.events   = EPOLLIN;
+      event.data.ptr = &conn;
+      epoll_ctl(epoll_, EPOLL_CTL_ADD, conn.fd, &event);
+    }
+    return true;
+  }
+
+  result run(clock_type::time_point deadline) {
+    result retval;
+    retval.latencies.reserve(1024 * 1024);
+    for (connection &conn : connections_) {
+      send(conn, retval);
+    }
+
+    char        buffer[READ_BUFFER_SIZE];
+    epoll_event events[MAX_EVENTS];
+    while (clock_type::now() < deadline) {
+      int count = epoll_wait(epoll_, events, MAX_EVENTS, 100);
+      for (int i = 0; i < count; ++i) {
+        connection &conn = *static_cast<connection *>(events[i].data.ptr);
+        ssize_t     size = read(conn.fd, buffer, sizeof(buffer));
+        if (size <= 0) {
+          ++retval.errors;
+          return retval;
+        }
+        conn.in.append(buffer, size);
+        receive(conn, retval);
+      }
+    }
+    return retval;
+  }
+
+private:
+  void send(connection &conn, result &res) {
+    clock_type::time_point now = clock_type::now();
+    std::fill(conn.sent.begin(), conn.sent.end(), now);
+    conn.answered = 0;
+    if (write(conn.fd, pipeline_.data(), pipeline_.size()) !=
+        static_cast<ssize_t>(pipeline_.size())) {
+      ++res.errors;
+    }
+  }
+
+  void receive(connection &conn, result &res) {
+    size_t offset = 0;
+    for (;;) {
+      std::string_view data{conn.in};
+      size_t           size = response_size(data.substr(offset));
+      if (size == 0) {
+        break;
+      } else if (size == std::string_view::npos) {
+        ++res.errors;
+        conn.in.clear();
+        return;
+      }
+      offset += size;
+
+      auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+          clock_type::now() - conn.sent[conn.answered]);
+      res.latencies.push_back(latency.count());
+      ++res.requests;
+      if (++conn.answered == depth_) {
+        send(conn, res);
+      }
+    }
+    conn.in.erase(0, offset);
+  }
+
+  const std::string      &pipeline_;
+  size_t                  depth_;
+  int                     epoll_;
+  std::vector<connection> connections_;
+};
+} // namespace
+
+/**\brief usage: load [port] [connections] [seconds] [pipeline] [threads]
+ * \param pipeline count of requests, that are sent at once by a connection
+ */
+int main(int argc, char *argv[]) {
+  uint16_t port        = argc > 1 ? atoi(argv[1]) : 8080;
+  size_t   connections = argc > 2 ? atoi(argv[2]) : 64;
+  unsigned seconds     = argc > 3 ? atoi(argv[3]) : 10;
+  size_t   depth       = argc > 4 ? atoi(argv[4]) : 1;
+  unsigned threads     = argc > 5 ? atoi(argv[5]) : 0;
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads     = std::max<unsigned>(1, std::min<size_t>(threads, connections));
+  depth       = std::max<size_t>(1, depth);
+  connections = std::max<size_t>(threads, connections);
+
+  std::string pipeline;
+  for (size_t i = 0; i < depth; ++i) {
+    pipeline.append(REQUEST);
+  }
+
+  clock_type::time_point start    = clock_type::now();
+  clock_type::time_point deadline = start + std::chrono::seconds{seconds};
+  std::vector<result>      results(threads);
+  std::vector<std::thread> loops;
+  std::atomic<bool>        failed{false};
+  for (unsigned i = 0; i < threads; ++i) {
+    size_t count = connections / threads + (i < connections % threads);
+    loops.emplace_back([&, i, count] {
+      client current{pipeline, depth};
+      if (current.open(port, count) == false) {
+        failed = true;
+        return;
+      }
+      results[i] = current.run(deadline);
+    });
+  }
+  for (std::thread &loop : loops) {
+    loop.join();
+  }
+  if (failed) {
+    fprintf(stderr, "can't connect to port %u\n", port);
+    return EXIT_FAILURE;
+  }
+  double elapsed = std::chrono::duration<double>(clock_type::now() - start)
+                       .count();
+
+  result total;
+  for (result &res : results) {
+    total.requests += res.requests;
+    total.errors += res.errors;
+    total.latencies.insert(
+        total.latencies.end(), res.latencies.begin(), res.latencies.end());
+  }
+  if (total.latencies.empty()) {
+    fprintf(stderr, "no responses, errors: %lu\n", total.errors);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<uint32_t> &latencies = total.latencies;
+  auto percentile = [&latencies](size_t percent) {
+    auto iter = latencies.begin() + (latencies.size() - 1) * percent / 100;
+    std::nth_element(latencies.begin(), iter, latencies.end());
+    return *iter;
+  };
+  printf("connections: %zu, pipeline: %zu, threads: %u\n",
+         connections,
+         depth,
+         threads);
+  printf("requests/s: %.0f\n", total.requests / elapsed);
+  printf("latency p50: %u us, p99: %u us\n", percentile(50), percentile(99));
+  printf("errors: %lu\n", total.errors);
+  return total.errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
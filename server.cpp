@@ -0,0 +1,551 @@
+// reference HTTP/1.1 server: one SO_REUSEPORT event loop per core (epoll or
+// io_uring), every connection has its own parser and reusable buffers
+
+#include "http_request_parser.hpp"
+#include "http_uring.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#define READ_BUFFER_SIZE (64 * 1024)
+#define BATCH_SIZE       16
+#define MAX_EVENTS       256
+
+#define URING_ENTRIES     1024
+#define URING_BUFFERS     1024
+#define URING_BUFFER_SIZE (16 * 1024)
+
+#define RESPONSE_BODY "Hello, World!"
+#define RESPONSE                                                              \
+  "HTTP/1.1 200 OK\r\n"                                                       \
+  "Server: simple-http-request-parser\r\n"                                    \
+  "Content-Type: text/plain\r\n"                                              \
+  "Content-Length: 13\r\n"                                                    \
+  "\r\n" RESPONSE_BODY
+#define BAD_REQUEST                                                           \
+  "HTTP/1.1 400 Bad Request\r\n"                                              \
+  "Content-Length: 0\r\n"                                                     \
+  "Connection: close\r\n"                                                     \
+  "\r\n"
+
+namespace {
+/**\brief requests without Content-Length have no body, so pipelined GET
+ * requests are not taken as body of previous request
+ */
+struct server_policy : http::default_policy {
+  static constexpr bool body_to_end = false;
+};
+using server_parser = http::basic_request_parser<server_policy>;
+
+/**\brief parser and parsed requests of one connection
+ */
+struct session {
+  server_parser parser;
+  /**\brief first request is incomplete request from previous read
+   */
+  http::request_view reqs[BATCH_SIZE];
+};
+
+/**\return true if connection must be closed after response
+ */
+bool is_last(const http::request_view &req) noexcept {
+  if (req.minor == 0) {
+    return req.keep_alive == false;
+  }
+  return http::detail::has_token(req.header(http::field::connection), "close");
+}
+
+/**\brief parse all pipelined requests from the data and append responses to
+ * them
+ * \return false if connection must be closed after the responses
+ */
+bool respond(session &sess, const char *data, size_t size, std::string &out) {
+  for (size_t offset = 0; offset < size;) {
+    server_parser::batch res = sess.parser.parse_batch(
+        data + offset, size - offset, sess.reqs, BATCH_SIZE);
+    // requests before invalid one are answered, as if they came separately
+    for (size_t i = 0; i < res.count; ++i) {
+      out.append(RESPONSE);
+      if (is_last(sess.reqs[i])) {
+        return false;
+      }
+    }
+    if (res.last == server_parser::error) {
+      out.append(BAD_REQUEST);
+      return false;
+    }
+    if ((res.last & server_parser::in_complete) && res.count != 0) {
+      sess.reqs[0] = sess.reqs[res.count];
+    }
+    offset += res.parsed;
+  }
+  return true;
+}
+
+/**\brief requests of one connection. Idle connection keeps only compact
+ * state of its parser, session is taken from pool of event loop when data
+ * arrives, and returned to the pool when all received requests are complete
+ */
+struct stream {
+  http::parser_state       state;
+  std::unique_ptr<session> busy;
+};
+
+class session_pool {
+public:
+  /**\see respond
+   */
+  bool respond(stream &conn, const char *data, size_t size, std::string &out) {
+    std::unique_ptr<session> sess = std::move(conn.busy);
+    if (sess == nullptr && free_.empty()) {
+      sess = std::make_unique<session>();
+      sess->parser.resume(conn.state);
+    } else if (sess == nullptr) {
+      sess = std::move(free_.back());
+      free_.pop_back();
+      sess->parser.resume(conn.state);
+    }
+
+    bool retval = ::respond(*sess, data, size, out);
+    if (sess->parser.idle()) {
+      conn.state = sess->parser.suspend();
+      free_.push_back(std::move(sess));
+    } else {
+      conn.busy = std::move(sess);
+    }
+    return retval;
+  }
+
+private:
+  std::vector<std::unique_ptr<session>> free_;
+};
+
+struct connection {
+  explicit connection(int socket) noexcept
+      : fd{socket}
+      , written{0}
+      , closing{false}
+      , writing{false} {
+    out.reserve(BATCH_SIZE * (sizeof(RESPONSE) - 1));
+  }
+
+  int    fd;
+  stream requests;
+  /**\brief responses that are not written yet
+   */
+  std::string out;
+  size_t      written;
+  /**\brief close connection after all responses are written
+   */
+  bool closing;
+  /**\brief socket buffer is full, so connection waits for EPOLLOUT
+   */
+  bool writing;
+};
+
+class epoll_worker {
+public:
+  epoll_worker(int listener, char *buffer) noexcept
+      : listener_{listener}
+      , epoll_{epoll_create1(EPOLL_CLOEXEC)}
+      , buffer_{buffer} {
+  }
+
+  ~epoll_worker() {
+    close(epoll_);
+  }
+
+  void run() {
+    watch(listener_, EPOLLIN, nullptr);
+
+    epoll_event events[MAX_EVENTS];
+    for (;;) {
+      int count = epoll_wait(epoll_, events, MAX_EVENTS, -1);
+      if (count < 0 && errno != EINTR) {
+        perror("epoll_wait");
+        return;
+      }
+
+      for (int i = 0; i < count; ++i) {
+        connection *conn = static_cast<connection *>(events[i].data.ptr);
+        if (conn == nullptr) {
+          accept_all();
+        } else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+          drop(conn);
+        } else if (events[i].events & EPOLLOUT) {
+          flush(conn);
+        } else {
+          receive(conn);
+        }
+      }
+    }
+  }
+
+private:
+  void watch(int fd, uint32_t events, connection *conn) noexcept {
+    epoll_event event{};
+    event.events   = events;
+    event.data.ptr = conn;
+    epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event);
+  }
+
+  void modify(connection *conn, uint32_t events) noexcept {
+    epoll_event event{};
+    event.events   = events;
+    event.data.ptr = conn;
+    epoll_ctl(epoll_, EPOLL_CTL_MOD, conn->fd, &event);
+  }
+
+  void accept_all() {
+    for (;;) {
+      int fd = accept4(listener_, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd < 0) {
+        return;
+      }
+      int on = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+      auto conn = std::make_unique<connection>(fd);
+      watch(fd, EPOLLIN | EPOLLRDHUP, conn.get());
+      connections_.emplace(fd, std::move(conn));
+    }
+  }
+
+  void drop(connection *conn) {
+    close(conn->fd);
+    connections_.erase(conn->fd);
+  }
+
+  /**\brief read all available data, parse all pipelined requests from it and
+   * answer them by one write
+   */
+  void receive(connection *conn) {
+    for (;;) {
+      ssize_t size = read(conn->fd, buffer_, READ_BUFFER_SIZE);
+      if (size == 0 || (size < 0 && errno != EAGAIN && errno != EINTR)) {
+        drop(conn);
+        return;
+      } else if (size < 0) {
+        break;
+      }
+
+      // buffer is reused by next read, incomplete request is saved in the
+      // parser
+      if (sessions_.respond(conn->requests, buffer_, size, conn->out) ==
+          false) {
+        conn->closing = true;
+        break;
+      } else if (size < READ_BUFFER_SIZE) {
+        break;
+      }
+    }
+    flush(conn);
+  }
+
+  void flush(connection *conn) {
+    while (conn->written < conn->out.size()) {
+      ssize_t size = write(conn->fd,
+                           conn->out.data() + conn->written,
+                           conn->out.size() - conn->written);
+      if (size < 0) {
+        if (errno == EAGAIN) {
+          // reading is stopped until client reads responses
+          if (conn->writing == false) {
+            conn->writing = true;
+            modify(conn, EPOLLOUT | EPOLLRDHUP);
+          }
+          return;
+        } else if (errno != EINTR) {
+          drop(conn);
+          return;
+        }
+      } else {
+        conn->written += size;
+      }
+    }
+
+    conn->out.clear();
+    conn->written = 0;
+    if (conn->closing) {
+      drop(conn);
+    } else if (conn->writing) {
+      conn->writing = false;
+      modify(conn, EPOLLIN | EPOLLRDHUP);
+    }
+  }
+
+  int          listener_;
+  int          epoll_;
+  char        *buffer_;
+  session_pool sessions_;
+  std::unordered_map<int, std::unique_ptr<connection>> connections_;
+};
+
+#ifdef __linux__
+enum operation : uint64_t {
+  op_accept,
+  op_receive,
+  op_send,
+};
+
+uint64_t tag(operation op, int fd) noexcept {
+  return op << 32 | static_cast<uint32_t>(fd);
+}
+
+/**\brief state of connection, which is served by io_uring. Socket is closed
+ * only when it has no operations in flight, so completions of closed socket
+ * never refer to new socket with the same descriptor
+ */
+struct uring_connection {
+  void reset() noexcept {
+    requests.state = http::parser_state{};
+    requests.busy.reset();
+    out.clear();
+    pending.clear();
+    written   = 0;
+    last      = false;
+    shut      = false;
+    sending   = false;
+    receiving = true;
+  }
+
+  stream requests;
+  /**\brief responses, that are sent now
+   */
+  std::string out;
+  /**\brief responses, that will be sent after current send
+   */
+  std::string pending;
+  size_t      written;
+  /**\brief close connection after all responses are sent
+   */
+  bool last;
+  /**\brief socket is shut down, it will be closed after last completion
+   */
+  bool shut;
+  bool sending;
+  bool receiving;
+};
+
+/**\brief multishot receive picks buffers from the ring, requests are parsed
+ * directly from the buffers, which are returned to the ring right after
+ * parsing
+ */
+class uring_worker {
+public:
+  explicit uring_worker(int listener) noexcept
+      : listener_{listener}
+      , ring_{URING_ENTRIES, URING_BUFFERS, URING_BUFFER_SIZE} {
+  }
+
+  /**\return false if io_uring is not supported
+   */
+  bool run() {
+    if (ring_.valid() == false || ring_.accept(listener_, tag(op_accept, 0)) ==
+                                      false) {
+      return false;
+    }
+
+    for (;;) {
+      if (ring_.submit_and_wait() == false) {
+        perror("io_uring_enter");
+        return true;
+      }
+      while (const io_uring_cqe *cqe = ring_.peek()) {
+        io_uring_cqe event = *cqe;
+        ring_.pop();
+        dispatch(event);
+      }
+    }
+  }
+
+private:
+  void dispatch(const io_uring_cqe &event) {
+    int  fd   = static_cast<uint32_t>(event.user_data);
+    bool more = event.flags & IORING_CQE_F_MORE;
+    switch (static_cast<operation>(event.user_data >> 32)) {
+    case op_accept:
+      if (event.res >= 0) {
+        open(event.res);
+      }
+      if (more == false) {
+        ring_.accept(listener_, tag(op_accept, 0));
+      }
+      break;
+    case op_receive:
+      receive(fd, *connections_[fd], event, more);
+      break;
+    case op_send:
+      sent(fd, *connections_[fd], event.res);
+      break;
+    }
+  }
+
+  void open(int fd) {
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    if (static_cast<size_t>(fd) >= connections_.size()) {
+      connections_.resize(fd + 1);
+    }
+    std::unique_ptr<uring_connection> &conn = connections_[fd];
+    if (conn == nullptr) {
+      conn = std::make_unique<uring_connection>();
+    }
+    conn->reset();
+    ring_.receive(fd, tag(op_receive, fd));
+  }
+
+  void receive(int                 fd,
+               uring_connection   &conn,
+               const io_uring_cqe &event,
+               bool                more) {
+    std::string_view data = ring_.buffer(event);
+    if (data.empty() == false && conn.last == false && conn.shut == false &&
+        sessions_.respond(
+            conn.requests, data.data(), data.size(), conn.pending) == false) {
+      conn.last = true;
+    }
+    ring_.recycle(event);
+
+    if (more == false) {
+      conn.receiving = false;
+      if (event.res <= 0 && event.res != -ENOBUFS) { // end of stream or error
+        conn.last = true;
+      } else if (conn.last == false && conn.shut == false) {
+        conn.receiving = true;
+        ring_.receive(fd, tag(op_receive, fd));
+      }
+    }
+    flush(fd, conn);
+  }
+
+  void sent(int fd, uring_connection &conn, int res) {
+    conn.sending = false;
+    if (res < 0) {
+      conn.last = true;
+      conn.out.clear();
+      conn.pending.clear();
+      conn.written = 0;
+    } else {
+      conn.written += res;
+    }
+    flush(fd, conn);
+  }
+
+  void flush(int fd, uring_connection &conn) {
+    if (conn.sending) {
+      return;
+    } else if (conn.written == conn.out.size()) {
+      conn.out.clear();
+      conn.written = 0;
+      conn.out.swap(conn.pending);
+    }
+
+    if (conn.written < conn.out.size()) {
+      conn.sending = true;
+      ring_.send(fd,
+                 conn.out.data() + conn.written,
+                 conn.out.size() - conn.written,
+                 tag(op_send, fd));
+      return;
+    }
+
+    if (conn.last && conn.shut == false) {
+      // stops multishot receive
+      conn.shut = true;
+      shutdown(fd, SHUT_RDWR);
+    }
+    if (conn.shut && conn.receiving == false) {
+      close(fd);
+    }
+  }
+
+  int                                            listener_;
+  http::uring                                    ring_;
+  session_pool                                   sessions_;
+  std::vector<std::unique_ptr<uring_connection>> connections_;
+};
+#endif
+
+int listen_on(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return -1;
+  }
+
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      listen(fd, SOMAXCONN) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+} // namespace
+
+/**\brief usage: server [port] [threads] [epoll|uring]
+ * \param threads count of event loops, by default count of cores
+ */
+int main(int argc, char *argv[]) {
+  uint16_t port    = argc > 1 ? atoi(argv[1]) : 8080;
+  unsigned threads = argc > 2 ? atoi(argv[2]) : 0;
+  bool     uring   = argc > 3 && strcmp(argv[3], "uring") == 0;
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  signal(SIGPIPE, SIG_IGN);
+
+  std::vector<std::thread> loops;
+  for (unsigned i = 0; i < threads; ++i) {
+    // every loop has its own listener, so kernel balances connections
+    int listener = listen_on(port);
+    if (listener < 0) {
+      perror("listen");
+      return EXIT_FAILURE;
+    }
+    loops.emplace_back([listener, uring] {
+#ifdef __linux__
+      // ring is created by its thread, because it has single issuer
+      if (uring && uring_worker{listener}.run()) {
+        return;
+      } else if (uring) {
+        perror("io_uring is not supported, epoll is used");
+      }
+#endif
+      std::unique_ptr<char[]> buffer{new char[READ_BUFFER_SIZE]};
+      epoll_worker{listener, buffer.get()}.run();
+    });
+  }
+  printf("listening on port %u, threads: %u, %s\n",
+         port,
+         threads,
+         uring ? "io_uring" : "epoll");
+
+  for (std::thread &loop : loops) {
+    loop.join();
+  }
+  return EXIT_SUCCESS;
+}
@@ -1,8 +1,26 @@
+#include "http_body_sink.hpp"
+#include "http_forward.hpp"
 #include "http_request_parser.hpp"
+#include "http_response_parser.hpp"
+#include "http_scan.hpp"
+#include "http_target.hpp"
+#include "http_uring.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#if __cplusplus >= 202002L
+#  include "http_coro.hpp"
+#endif
 
 #define CHECK_COMPLETE(str,                                                   \
                        verb,                                                  \
@@ -134,6 +152,669 @@
   }
 
 
+#define CHECK_FLAT_HEADERS(str)                                               \
+  {                                                                           \
+    http::request      val;                                                   \
+    http::flat_request flat;                                                  \
+    http::request_view view;                                                  \
+    if (parser.parse((const void *)str, strlen(str), val) !=                  \
+            http::request_parser::status::done ||                             \
+        parser.parse((const void *)str, strlen(str), flat) !=                 \
+            http::request_parser::status::done ||                             \
+        parser.parse((const void *)str, strlen(str), view) !=                 \
+            http::request_parser::status::done) {                             \
+      std::cerr << "unexpected problem during parsing http request\n"         \
+                << str << std::endl;                                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+    bool same = val.headers.size() == flat.headers.size();                    \
+    for (const auto &[key, value] : val.headers) {                            \
+      http::flat_headers::const_iterator found = flat.headers.find(key);      \
+      same = same && found != flat.headers.end() && found->second == value;   \
+    }                                                                         \
+    if (same == false || flat.headers != http::flat_request{view}.headers) {  \
+      std::cerr << "flat headers differ from headers\n"                       \
+                << str << std::endl;                                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+  }
+
+
+#define CHECK_REUSE(req, str, h_key, h_val)                                   \
+  {                                                                           \
+    req.reset();                                                              \
+    if (parser.parse((const void *)str, strlen(str), req) !=                  \
+        http::request_parser::status::done) {                                 \
+      std::cerr << "unexpected problem during parsing http request\n"         \
+                << str << std::endl;                                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+    if (req.headers.size() != 1 || req.headers.count(h_key) == 0 ||           \
+        req.headers[h_key] != h_val) {                                        \
+      std::cerr << "expected only `" << h_key << ": " << h_val << "`\n"       \
+                << str << std::endl;                                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+  }
+
+
+#define CHECK_COMPLETE_VIEW(str, verb, resource, h_key, h_val)                \
+  {                                                                           \
+    http::request_view val;                                                   \
+    size_t             parsed = 0;                                            \
+    if (parser.parse((const void *)str, strlen(str), val, &parsed) !=         \
+        http::request_parser::status::done) {                                 \
+      std::cerr << "unexpected problem during parsing http request: "         \
+                << parsed << "/" << strlen(str) << "\n"                       \
+                << str << std::endl;                                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+    if (val.method != verb || val.target != resource) {                       \
+      std::cerr << "invalid request line, expected `" << verb << " "          \
+                << resource << "`, got: " << val.method << " " << val.target  \
+                << "\n"                                                       \
+                << str << std::endl;                                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+    if (val.header(h_key) != h_val) {                                         \
+      std::cerr << "expected `" << h_key << ": " << h_val                     \
+                << "`, but got: " << h_key << ": " << val.header(h_key)       \
+                << "\n"                                                       \
+                << str << std::endl;                                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+    http::request req{val};                                                   \
+    if (req.method != verb || req.target != resource ||                       \
+        req.major != val.major || req.minor != val.minor ||                   \
+        req.content_length != val.content_length ||                           \
+        req.keep_alive != val.keep_alive) {                                   \
+      std::cerr << "request built from view is not same as view\n"            \
+                << str << std::endl;                                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+  }
+
+#define CHECK_SCAN(lvl)                                                       \
+  {                                                                           \
+    const http::scan::kernels &expected = http::scan::get(http::scan::scalar); \
+    const http::scan::kernels &kernels  = http::scan::get(lvl);               \
+    const char stops[] = {                                                    \
+        '\r', '\n', ' ', '\t', ':', '%', '+', 127, (char)128, 0};             \
+    char       buf[100];                                                      \
+    for (char stop : stops) {                                                 \
+      for (size_t pos = 0; pos < sizeof(buf); ++pos) {                        \
+        memset(buf, 'a', sizeof(buf));                                        \
+        buf[pos] = stop;                                                      \
+        for (size_t offset = 0; offset < 4; ++offset) {                       \
+          const char *begin = buf + offset;                                   \
+          const char *end   = buf + sizeof(buf);                              \
+          if (kernels.vchar(begin, end) != expected.vchar(begin, end) ||      \
+              kernels.header_key(begin, end) !=                               \
+                  expected.header_key(begin, end) ||                          \
+              kernels.header_value(begin, end) !=                             \
+                  expected.header_value(begin, end) ||                        \
+              kernels.url_plain(begin, end) !=                                \
+                  expected.url_plain(begin, end)) {                           \
+            std::cerr << "invalid scan result for level " << lvl              \
+                      << ", stop octet: " << (int)stop                        \
+                      << ", position: " << pos << std::endl;                  \
+            return EXIT_FAILURE;                                              \
+          }                                                                   \
+        }                                                                     \
+      }                                                                       \
+    }                                                                         \
+  }
+
+#define CHECK_HEADER_END(lvl)                                                 \
+  {                                                                           \
+    const http::scan::kernels &kernels = http::scan::get(lvl);                \
+    char                       buf[100];                                      \
+    for (size_t pos = 0; pos <= sizeof(buf); ++pos) {                         \
+      /* decoys contain CRLFCR, but not CRLFCRLF */                           \
+      for (size_t i = 0; i < sizeof(buf); ++i) {                              \
+        buf[i] = "a\r\n\r"[i % 4];                                            \
+      }                                                                       \
+      if (pos + 4 <= sizeof(buf)) {                                           \
+        memcpy(buf + pos, "\r\n\r\n", 4);                                     \
+      }                                                                       \
+      for (size_t cut = 0; cut < 4; ++cut) {                                  \
+        const char *end      = buf + sizeof(buf) - cut;                       \
+        const char *found    = kernels.header_end(buf, end);                  \
+        size_t      index    = std::string_view{buf, sizeof(buf) - cut}       \
+                               .find("\r\n\r\n");                             \
+        const char *expected = index == std::string_view::npos                \
+                                   ? end                                      \
+                                   : buf + index;                             \
+        if (found != expected) {                                              \
+          std::cerr << "invalid end of headers for level " << lvl             \
+                    << ", position: " << pos << ", cut: " << cut              \
+                    << std::endl;                                             \
+          return EXIT_FAILURE;                                                \
+        }                                                                     \
+      }                                                                       \
+    }                                                                         \
+  }
+
+#define CHECK_LAZY(str, lazy_block)                                           \
+  {                                                                           \
+    http::request_view expected;                                              \
+    if (parser.parse((const void *)str, strlen(str), expected) !=             \
+        http::request_parser::status::done) {                                 \
+      std::cerr << "unexpected problem during parsing http request\n"         \
+                << str << std::endl;                                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+    for (size_t step = strlen(str); step > 0; --step) {                       \
+      http::lazy_request_view      view;                                      \
+      http::request_parser         lazy_parser;                               \
+      http::request_parser::status status = http::request_parser::error;      \
+      for (size_t offset = 0; offset < strlen(str); offset += step) {         \
+        size_t size = std::min(step, strlen(str) - offset);                   \
+        status      = lazy_parser.parse(str + offset, size, view);            \
+      }                                                                       \
+      if (status != http::request_parser::status::done) {                     \
+        std::cerr << "lazy request is not parsed, fragment size: " << step    \
+                  << "\n"                                                     \
+                  << str << std::endl;                                        \
+        return EXIT_FAILURE;                                                  \
+      }                                                                       \
+      if (step == strlen(str) && view.header_block.empty() == lazy_block) {   \
+        std::cerr << "unexpected header block: " << view.header_block         \
+                  << "\n"                                                     \
+                  << str << std::endl;                                        \
+        return EXIT_FAILURE;                                                  \
+      }                                                                       \
+      bool same = view.method == expected.method &&                           \
+                  view.target == expected.target &&                           \
+                  view.content_length == expected.content_length &&           \
+                  view.keep_alive == expected.keep_alive &&                   \
+                  view.headers_count() == expected.headers_count;             \
+      for (size_t i = 0; same && i < expected.headers_count; ++i) {           \
+        const http::header_field &field = expected.headers[i];                \
+        same = view.headers()[i].name == field.name &&                        \
+               view.headers()[i].value == field.value &&                      \
+               view.header(field.name) == expected.header(field.name);        \
+      }                                                                       \
+      if (same == false) {                                                    \
+        std::cerr << "lazy request is not same as request view, "             \
+                  << "fragment size: " << step << "\n"                        \
+                  << str << std::endl;                                        \
+        return EXIT_FAILURE;                                                  \
+      }                                                                       \
+    }                                                                         \
+  }
+
+#define CHECK_DECODE(str, plus_as_space, expected)                            \
+  {                                                                           \
+    std::string src{str};                                                     \
+    std::string out(src.size(), '\0');                                        \
+    size_t size = http::percent_decode(src, out.data(), plus_as_space);       \
+    /* decoding in place must give same result */                             \
+    size_t in_place = http::percent_decode(src, src.data(), plus_as_space);   \
+    if (size != in_place ||                                                   \
+        (size != std::string_view::npos &&                                    \
+         (out.substr(0, size) != expected ||                                  \
+          src.substr(0, in_place) != expected))) {                            \
+      std::cerr << "invalid decoding of `" << str << "`: "                    \
+                << out.substr(0, size) << std::endl;                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+  }
+
+#define CHECK_TARGET(str, t_path, t_query, t_segments, t_params)              \
+  {                                                                           \
+    http::target_view view{str};                                              \
+    std::string       joined_segments;                                        \
+    std::string       joined_params;                                          \
+    for (size_t i = 0; i < view.segments_count(); ++i) {                      \
+      joined_segments.append(view.segment(i)).append("|");                    \
+    }                                                                         \
+    for (size_t i = 0; i < view.params_count(); ++i) {                        \
+      joined_params.append(view.param(i).key)                                 \
+          .append("=")                                                        \
+          .append(view.param(i).value)                                        \
+          .append("|");                                                       \
+    }                                                                         \
+    if (view.path() != t_path || view.query() != t_query ||                   \
+        joined_segments != t_segments || joined_params != t_params) {         \
+      std::cerr << "invalid index of target `" << str << "`: path "           \
+                << view.path() << ", query " << view.query()                  \
+                << ", segments " << joined_segments << ", params "            \
+                << joined_params << std::endl;                                \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+  }
+
+#define CHECK_FRAGMENTED(str)                                                 \
+  {                                                                           \
+    http::request expected;                                                   \
+    if (parser.parse((const void *)str, strlen(str), expected) !=             \
+        http::request_parser::status::done) {                                 \
+      std::cerr << "unexpected problem during parsing http request\n"         \
+                << str << std::endl;                                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+    for (size_t step = 1; step <= strlen(str); ++step) {                      \
+      http::request                req;                                       \
+      http::request_view           view;                                      \
+      http::request_parser         view_parser;                               \
+      http::request_parser::status status      = http::request_parser::error; \
+      http::request_parser::status view_status = http::request_parser::error; \
+      char                         fragment[sizeof(str)];                     \
+      for (size_t offset = 0; offset < strlen(str); offset += step) {         \
+        size_t size = std::min(step, strlen(str) - offset);                   \
+        memcpy(fragment, str + offset, size);                                 \
+        status      = parser.parse(fragment, size, req);                      \
+        view_status = view_parser.parse(fragment, size, view);                \
+      }                                                                       \
+      if (status != http::request_parser::status::done ||                     \
+          view_status != http::request_parser::status::done) {                \
+        std::cerr << "fragmented request is not parsed, fragment size: "      \
+                  << step << "\n"                                             \
+                  << str << std::endl;                                        \
+        return EXIT_FAILURE;                                                  \
+      }                                                                       \
+      http::request from_view{view};                                          \
+      if (req.method != expected.method ||                                    \
+          req.method_id != expected.method_id ||                              \
+          req.target != expected.target ||                                    \
+          req.headers != expected.headers ||                                  \
+          from_view.method != expected.method ||                              \
+          from_view.target != expected.target ||                              \
+          from_view.headers != expected.headers) {                            \
+        std::cerr << "fragmented request is not same as complete one, "       \
+                  << "fragment size: " << step << "\n"                        \
+                  << str << std::endl;                                        \
+        return EXIT_FAILURE;                                                  \
+      }                                                                       \
+    }                                                                         \
+  }
+
+#define CHECK_CHUNKED(str, expected_body, h_key, h_val)                       \
+  {                                                                           \
+    for (size_t step = 1; step <= strlen(str); ++step) {                      \
+      http::request                req;                                       \
+      http::request_parser::status status = http::request_parser::error;      \
+      std::string                  body;                                      \
+      char                         fragment[sizeof(str)];                     \
+      for (size_t offset = 0; offset < strlen(str); offset += step) {         \
+        size_t size = std::min(step, strlen(str) - offset);                   \
+        memcpy(fragment, str + offset, size);                                 \
+        size_t parsed = 0;                                                    \
+        for (size_t pos = 0; pos < size; pos += parsed) {                     \
+          status = parser.parse(fragment + pos, size - pos, req, &parsed);    \
+          if (status == http::request_parser::status::error) {                \
+            std::cerr << "chunked request is not parsed, fragment size: "     \
+                      << step << "\n"                                         \
+                      << str << std::endl;                                    \
+            return EXIT_FAILURE;                                              \
+          }                                                                   \
+          if (req.chunked && req.body_size != 0) {                            \
+            body.append((const char *)req.body, req.body_size);               \
+          }                                                                   \
+        }                                                                     \
+      }                                                                       \
+      if (status != http::request_parser::status::done ||                     \
+          body != expected_body || req.content_length != 0 ||                 \
+          req.headers[h_key] != h_val) {                                      \
+        std::cerr << "invalid chunked request, fragment size: " << step       \
+                  << ", body: " << body << "\n"                               \
+                  << str << std::endl;                                        \
+        return EXIT_FAILURE;                                                  \
+      }                                                                       \
+    }                                                                         \
+  }
+
+struct route_handler : public http::request_handler {
+  std::string method;
+  std::string target;
+  std::string host;
+  size_t      body_size = 0;
+  bool        complete  = false;
+
+  void on_method(http::verb /*id*/, std::string_view val) {
+    method = val;
+  }
+
+  void on_target(std::string_view val) {
+    target = val;
+  }
+
+  bool on_header(http::field id,
+                 std::string_view /*name*/,
+                 std::string_view value) {
+    if (id == http::field::host) {
+      host = value;
+    }
+    return true;
+  }
+
+  void on_body(std::string_view data) noexcept {
+    body_size += data.size();
+  }
+
+  void on_message_complete() noexcept {
+    complete = true;
+  }
+};
+
+#define CHECK_HANDLER(str, verb, resource, h_host, b_size)                    \
+  {                                                                           \
+    route_handler handler;                                                    \
+    size_t        parsed = 0;                                                 \
+    if (parser.parse((const void *)str, strlen(str), handler, &parsed) !=     \
+            http::request_parser::status::done ||                             \
+        parsed != strlen(str) || handler.complete == false) {                 \
+      std::cerr << "unexpected problem during parsing http request: "         \
+                << parsed << "/" << strlen(str) << "\n"                       \
+                << str << std::endl;                                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+    if (handler.method != verb || handler.target != resource ||               \
+        handler.host != h_host || handler.body_size != b_size) {              \
+      std::cerr << "invalid handler result: " << handler.method << " "        \
+                << handler.target << ", host: " << handler.host               \
+                << ", body size: " << handler.body_size << "\n"               \
+                << str << std::endl;                                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+  }
+
+#define CHECK_BATCH(str, batch_size, expected_targets)                        \
+  {                                                                           \
+    for (size_t split = 0; split <= strlen(str); ++split) {                   \
+      http::request_parser batch_parser;                                      \
+      http::request_view   reqs[batch_size];                                  \
+      std::string          targets;                                           \
+      char                 fragment[sizeof(str)];                             \
+      size_t               sizes[] = {split, strlen(str) - split};            \
+      const char          *pos     = str;                                     \
+      for (size_t size : sizes) {                                             \
+        memcpy(fragment, pos, size);                                          \
+        pos += size;                                                          \
+        for (size_t offset = 0; offset < size;) {                             \
+          http::request_parser::batch result = batch_parser.parse_batch(      \
+              fragment + offset, size - offset, reqs, batch_size);            \
+          if (result.last == http::request_parser::status::error) {           \
+            std::cerr << "batch is not parsed, split: " << split << "\n"      \
+                      << str << std::endl;                                    \
+            return EXIT_FAILURE;                                              \
+          }                                                                   \
+          for (size_t i = 0; i < result.count; ++i) {                         \
+            targets.append(reqs[i].target).append(" ");                       \
+          }                                                                   \
+          if (result.last & http::request_parser::status::in_complete) {      \
+            reqs[0] = reqs[result.count];                                     \
+          }                                                                   \
+          offset += result.parsed;                                            \
+        }                                                                     \
+      }                                                                       \
+      if (targets != expected_targets) {                                      \
+        std::cerr << "invalid batch: " << targets << ", split: " << split     \
+                  << "\n"                                                     \
+                  << str << std::endl;                                        \
+        return EXIT_FAILURE;                                                  \
+      }                                                                       \
+    }                                                                         \
+  }
+
+#define CHECK_FORWARD(forward, str, expected)                                 \
+  {                                                                           \
+    for (size_t step = 1; step <= strlen(str); ++step) {                      \
+      http::request_parser         forward_parser;                            \
+      http::request_view           view;                                      \
+      http::request_parser::status status = http::request_parser::error;      \
+      char                         fragment[sizeof(str)];                     \
+      size_t                       size = 0;                                  \
+      for (size_t offset = 0; offset < strlen(str); offset += step) {         \
+        size = std::min(step, strlen(str) - offset);                          \
+        memcpy(fragment, str + offset, size);                                 \
+        status = forward_parser.parse(fragment, size, view);                  \
+      }                                                                       \
+      iovec  iov[64];                                                         \
+      size_t count =                                                          \
+          forward.serialize(view, std::string_view{fragment, size}, iov, 64); \
+      std::string forwarded;                                                  \
+      for (size_t i = 0; i < count; ++i) {                                    \
+        forwarded.append(static_cast<const char *>(iov[i].iov_base),          \
+                         iov[i].iov_len);                                     \
+      }                                                                       \
+      if (status != http::request_parser::status::done ||                     \
+          forwarded != expected) {                                            \
+        std::cerr << "invalid forwarded request, fragment size: " << step     \
+                  << "\n"                                                     \
+                  << forwarded << std::endl;                                  \
+        return EXIT_FAILURE;                                                  \
+      }                                                                       \
+    }                                                                         \
+  }
+
+#define CHECK_RESPONSE(method, str, code, expected_reason, expected_body)     \
+  {                                                                           \
+    for (size_t step = 1; step <= strlen(str); ++step) {                      \
+      http::response_parser         res_parser;                               \
+      http::response_view           res;                                      \
+      http::response_parser::status status = http::response_parser::error;    \
+      std::string                   body;                                     \
+      char                          fragment[sizeof(str)];                    \
+      res_parser.request_method(method);                                      \
+      for (size_t offset = 0; offset < strlen(str);) {                        \
+        size_t size   = std::min(step, strlen(str) - offset);                 \
+        size_t parsed = 0;                                                    \
+        memcpy(fragment, str + offset, size);                                 \
+        for (size_t pos = 0; pos < size; pos += parsed) {                     \
+          status =                                                            \
+              res_parser.parse(fragment + pos, size - pos, res, &parsed);     \
+          body.append(res.body);                                              \
+          offset += parsed;                                                   \
+          if (status == http::response_parser::error ||                       \
+              status == http::response_parser::done) {                        \
+            break;                                                            \
+          }                                                                   \
+        }                                                                     \
+        if (status == http::response_parser::error ||                         \
+            status == http::response_parser::done) {                          \
+          break;                                                              \
+        }                                                                     \
+      }                                                                       \
+      if (status != http::response_parser::error &&                           \
+          status != http::response_parser::done) {                            \
+        status = res_parser.finish(); /* body delimited by close */           \
+      }                                                                       \
+      if (status != http::response_parser::done || res.status_code != code || \
+          res.reason != expected_reason || body != expected_body) {           \
+        std::cerr << "invalid response, fragment size: " << step << ", "      \
+                  << res.status_code << " " << res.reason << "\n"             \
+                  << body << "\n"                                             \
+                  << str << std::endl;                                        \
+        return EXIT_FAILURE;                                                  \
+      }                                                                       \
+    }                                                                         \
+  }
+
+#define CHECK_RESPONSE_ERROR(parser_type, str)                                \
+  {                                                                           \
+    parser_type   res_parser;                                                 \
+    http::response_view res;                                                  \
+    if (res_parser.parse(str, strlen(str), res) !=                            \
+        http::response_parser::error) {                                       \
+      std::cerr << "invalid response is accepted\n" << str << std::endl;      \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+  }
+
+#define CHECK_VERB(str, verb, id, maj, min)                                   \
+  {                                                                           \
+    http::request_view val;                                                   \
+    if (parser.parse((const void *)str, strlen(str), val) !=                  \
+        http::request_parser::status::done) {                                 \
+      std::cerr << "unexpected problem during parsing http request\n"         \
+                << str << std::endl;                                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+    if (val.method != verb || val.method_id != id || val.major != maj ||      \
+        val.minor != min) {                                                   \
+      std::cerr << "invalid request line: " << val.method << " HTTP/"         \
+                << val.major << "." << val.minor << "\n"                      \
+                << str << std::endl;                                          \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+  }
+
+#define CHECK_LIMIT(limit, val, str, code)                                    \
+  {                                                                           \
+    http::parser_limits limits;                                               \
+    limits.limit = val;                                                       \
+    for (size_t step : {strlen(str), size_t{1}}) {                            \
+      http::request_parser limited{                                           \
+          http::request_parser::default_spill_capacity, limits};              \
+      http::request_view           view;                                      \
+      http::request_parser::status status = http::request_parser::done;       \
+      size_t                       parsed = 0;                                \
+      for (size_t offset = 0; offset < strlen(str); offset += parsed) {       \
+        size_t size = std::min(step, strlen(str) - offset);                   \
+        status      = limited.parse(str + offset, size, view, &parsed);       \
+        if (status == http::request_parser::status::error) {                  \
+          break;                                                              \
+        }                                                                     \
+      }                                                                       \
+      if (status != http::request_parser::status::error ||                    \
+          limited.last_error() != code) {                                     \
+        std::cerr << "expected error " << static_cast<int>(code)              \
+                  << ", but got " << static_cast<int>(limited.last_error())   \
+                  << ", fragment size: " << step << "\n"                      \
+                  << str << std::endl;                                        \
+        return EXIT_FAILURE;                                                  \
+      }                                                                       \
+    }                                                                         \
+  }
+
+#define CHECK_POLICY(parser_type, str, accepted)                              \
+  {                                                                           \
+    for (size_t step : {strlen(str), size_t{1}}) {                            \
+      parser_type                  policy_parser;                             \
+      http::request_view           view;                                      \
+      http::request_parser::status status = http::request_parser::error;      \
+      size_t                       parsed = 0;                                \
+      for (size_t offset = 0; offset < strlen(str); offset += parsed) {       \
+        size_t size = std::min(step, strlen(str) - offset);                   \
+        status = policy_parser.parse(str + offset, size, view, &parsed);      \
+        if (status == http::request_parser::status::error) {                  \
+          break;                                                              \
+        }                                                                     \
+      }                                                                       \
+      if ((status == http::request_parser::status::done) != accepted) {       \
+        std::cerr << "request must be "                                       \
+                  << (accepted ? "accepted" : "rejected") << " by "           \
+                  << #parser_type << ", fragment size: " << step              \
+                  << "\n"                                                     \
+                  << str << std::endl;                                        \
+        return EXIT_FAILURE;                                                  \
+      }                                                                       \
+    }                                                                         \
+  }
+
+#define CHECK_FIELD(name, id)                                                 \
+  {                                                                           \
+    if (http::to_field(name) != id) {                                         \
+      std::cerr << "invalid field for header name: " << name << std::endl;    \
+      return EXIT_FAILURE;                                                    \
+    }                                                                         \
+  }
+
+/**\brief rejects absolute and authority form of target
+ */
+struct origin_policy : http::strict_policy {
+  static constexpr bool absolute_form = false;
+};
+
+using origin_parser = http::basic_request_parser<origin_policy>;
+
+/**\brief parses only framing headers
+ */
+struct skip_policy : http::default_policy {
+  static constexpr bool capture_headers = false;
+};
+
+/**\brief collects stats of parsing
+ */
+struct stats_policy : http::default_policy {
+  static constexpr bool stats = true;
+};
+
+#if __cplusplus >= 202002L
+#  define CHECK_READER(str, buffer_size, bodies, expected, error)             \
+    {                                                                         \
+      for (size_t step = 1; step <= strlen(str); ++step) {                    \
+        fragment_stream                      stream{str, step, 0};            \
+        http::request_reader<fragment_stream> reader{stream, buffer_size};    \
+        std::string                          out;                             \
+        bool                                 finished = false;                \
+        http::spawn(read_requests(reader, bodies, out, finished));            \
+        if (finished == false || out != expected ||                           \
+            reader.last_error() != error) {                                   \
+          std::cerr << "invalid requests from reader, fragment size: "        \
+                    << step << "\n"                                           \
+                    << out << std::endl;                                      \
+          return EXIT_FAILURE;                                                \
+        }                                                                     \
+      }                                                                       \
+    }
+
+/**\brief stream of the text, which is read by fragments of the step size
+ * without suspension
+ */
+struct fragment_stream {
+  struct read_op {
+    bool await_ready() noexcept {
+      return true;
+    }
+
+    void await_suspend(std::coroutine_handle<> /*handle*/) noexcept {
+    }
+
+    ptrdiff_t await_resume() noexcept {
+      return size;
+    }
+
+    ptrdiff_t size;
+  };
+
+  read_op read_some(void *buf, size_t size) noexcept {
+    size = std::min({size, step, text.size() - offset});
+    memcpy(buf, text.data() + offset, size);
+    offset += size;
+    return read_op{static_cast<ptrdiff_t>(size)};
+  }
+
+  std::string_view text;
+  size_t           step;
+  size_t           offset;
+};
+
+/**\brief read all requests from the stream, every request is written to out
+ * as "method target body\n"
+ * \param bodies if false, then bodies are skipped by the reader
+ */
+template <http::byte_stream Stream>
+http::task<void> read_requests(http::request_reader<Stream> &reader,
+                               bool                          bodies,
+                               std::string                  &out,
+                               bool                         &finished) {
+  while (co_await reader.next_request()) {
+    const http::request_view &req = reader.request();
+    out.append(req.method).append(" ").append(req.target).append(" ");
+    for (std::string_view chunk = co_await reader.body_chunk();
+         bodies && chunk.empty() == false;
+         chunk = co_await reader.body_chunk()) {
+      out.append(chunk);
+    }
+    out.append("\n");
+  }
+  finished = true;
+}
+#endif
+
 int main() {
   http::request_parser parser;
 
@@ -341,5 +1022,1567 @@ int main() {
                         "Host",
                         "www.example.com:80");
 
+  // check request view
+  CHECK_COMPLETE_VIEW("GET /tmp HTTP/1.1\r\n"
+                      "Content-Type:  plain/text \r\n"
+                      "\r\n",
+                      "GET",
+                      "/tmp",
+                      "content-type",
+                      "plain/text");
+  CHECK_COMPLETE_VIEW("POST /blah HTTP/1.1\r\n"
+                      "Some-Header:  blah,   tmp,\tval\r\n"
+                      "Content-Length:5\r\n"
+                      "\r\n"
+                      "hello",
+                      "POST",
+                      "/blah",
+                      "Some-Header",
+                      "blah,   tmp,\tval");
+  CHECK_COMPLETE_VIEW("PUT http://localhost:8000/blah HTTP/1.1\r\n"
+                      "\r\n",
+                      "PUT",
+                      "/blah",
+                      "Host",
+                      "localhost:8000");
+
+  // check simd scanners
+  CHECK_SCAN(http::scan::sse42);
+  CHECK_SCAN(http::scan::avx2);
+  CHECK_HEADER_END(http::scan::scalar);
+  CHECK_HEADER_END(http::scan::sse42);
+  CHECK_HEADER_END(http::scan::avx2);
+  CHECK_COMPLETE_HEADER("GET /some/very/long/path/which/is/longer/then/32 "
+                        "HTTP/1.1\r\n"
+                        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) "
+                        "AppleWebKit/537.36 (KHTML, like Gecko)   \r\n"
+                        "\r\n",
+                        "User-Agent",
+                        "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+                        "(KHTML, like Gecko)");
+
+  // check requests split between several buffers
+  CHECK_FRAGMENTED("GET /some/uri?tmp=blah HTTP/1.1\r\n"
+                   "Content-Type:  plain/text, \r\n"
+                   "\tapplication/json\r\n"
+                   "Connection: keep-alive\r\n"
+                   "\r\n");
+  CHECK_FRAGMENTED("PUT http://localhost:8000/blah HTTP/1.1\r\n"
+                   "Content-Length: 5\r\n"
+                   "\r\n"
+                   "hello");
+  CHECK_FRAGMENTED("CONNECT www.example.com:80 HTTP/1.1\n"
+                   "Some-Header:\n"
+                   "\n");
+
+  // check chunked body
+  CHECK_CHUNKED("POST /upload HTTP/1.1\r\n"
+                "Transfer-Encoding: chunked\r\n"
+                "\r\n"
+                "5\r\n"
+                "hello\r\n"
+                "1;name=val\r\n"
+                " \r\n"
+                "0000a\r\n"
+                "world\r\n!!!\r\n"
+                "0\r\n"
+                "\r\n",
+                "hello world\r\n!!!",
+                "Transfer-Encoding",
+                "chunked");
+  CHECK_CHUNKED("PUT /upload HTTP/1.1\n"
+                "Content-Length: 100\n"
+                "Transfer-Encoding: gzip, Chunked\n"
+                "\n"
+                "B\n"
+                "hello world\n"
+                "0\n"
+                "Some-Trailer: val\n"
+                "\n",
+                "hello world",
+                "Some-Trailer",
+                "val");
+  for (const char *str : {"\r\n",
+                          "zz\r\n",
+                          "5zz\r\nhello\r\n",
+                          ";ext\r\n"}) {
+    std::string request = "POST /upload HTTP/1.1\r\n"
+                          "Transfer-Encoding: chunked\r\n"
+                          "\r\n";
+    request += str;
+    request += "\r\n";
+    CHECK_POLICY(http::request_parser, request.c_str(), false);
+  }
+  {
+    // stop after chunk is not a suspend, so fields are not copied to spill
+    const char *str = "POST /upload HTTP/1.1\r\n"
+                      "Transfer-Encoding: chunked\r\n"
+                      "X-Name: value\r\n"
+                      "\r\n"
+                      "5\r\nhello\r\n"
+                      "0\r\n"
+                      "\r\n";
+    http::request_parser         chunked_parser;
+    http::request_view           view;
+    http::request_parser::status status = http::request_parser::error;
+    size_t                       parsed = 0;
+    bool                         copied = false;
+    for (size_t offset = 0; offset < strlen(str); offset += parsed) {
+      status = chunked_parser.parse(
+          str + offset, strlen(str) - offset, view, &parsed);
+      copied |= view.header("X-Name").data() != strstr(str, "value");
+      copied |= view.target.data() != strstr(str, "/upload");
+    }
+    if (status != http::request_parser::status::done || copied) {
+      std::cerr << "fields of chunked request in one buffer are copied"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // check handler
+  CHECK_HANDLER("GET /tmp HTTP/1.1\r\n"
+                "Host: localhost\r\n"
+                "Content-Type: plain/text\r\n"
+                "\r\n",
+                "GET",
+                "/tmp",
+                "localhost",
+                0);
+  CHECK_HANDLER("POST http://localhost:8000/blah HTTP/1.1\r\n"
+                "Content-Length: 5\r\n"
+                "\r\n"
+                "hello",
+                "POST",
+                "/blah",
+                "localhost:8000",
+                5);
+  CHECK_HANDLER("POST /upload HTTP/1.1\r\n"
+                "Host: localhost\r\n"
+                "Transfer-Encoding: chunked\r\n"
+                "\r\n"
+                "5\r\n"
+                "hello\r\n"
+                "0\r\n"
+                "\r\n",
+                "POST",
+                "/upload",
+                "localhost",
+                5);
+
+  // check well known header names
+  CHECK_FIELD("Host", http::field::host);
+  CHECK_FIELD("CONTENT-LENGTH", http::field::content_length);
+  CHECK_FIELD("x-forwarded-for", http::field::x_forwarded_for);
+  CHECK_FIELD("Hosts", http::field::unknown);
+  CHECK_FIELD("Content-Lengtx", http::field::unknown);
+  CHECK_FIELD("", http::field::unknown);
+  CHECK_COMPLETE_VIEW("GET /tmp HTTP/1.1\r\n"
+                      "Accept: text/html\r\n"
+                      "accept: application/json\r\n"
+                      "\r\n",
+                      "GET",
+                      "/tmp",
+                      "ACCEPT",
+                      "text/html");
+
+  // check flat headers
+  CHECK_FLAT_HEADERS("GET /tmp HTTP/1.1\r\n"
+                     "Host: localhost\r\n"
+                     "Accept: text/html\r\n"
+                     "X-Custom: one\r\n"
+                     "accept: application/json\r\n"
+                     "x-custom:  two,\r\n"
+                     " three\r\n"
+                     "Empty:\r\n"
+                     "Content-Length: 0\r\n"
+                     "\r\n");
+  CHECK_FLAT_HEADERS("GET /tmp HTTP/1.1\r\n"
+                     "\r\n");
+
+  // check reuse of request
+  {
+    http::request      req;
+    http::flat_request flat;
+    CHECK_REUSE(req, "GET / HTTP/1.1\r\nHost: one\r\n\r\n", "Host", "one");
+    CHECK_REUSE(req, "GET / HTTP/1.1\r\nX-Key: two\r\n\r\n", "X-Key", "two");
+    CHECK_REUSE(flat, "GET / HTTP/1.1\r\nHost: one\r\n\r\n", "Host", "one");
+    CHECK_REUSE(flat, "GET / HTTP/1.1\r\nX-Key: two\r\n\r\n", "X-Key", "two");
+  }
+
+  // check request in arena, which can not allocate from heap
+  {
+    char                                buffer[4096];
+    std::pmr::monotonic_buffer_resource arena{buffer,
+                                              sizeof(buffer),
+                                              std::pmr::null_memory_resource()};
+    http::pmr_request                   req{&arena};
+    CHECK_REUSE(req,
+                "GET / HTTP/1.1\r\n"
+                "X-Long-Header-Name: long header value\r\n"
+                "\r\n",
+                "x-long-header-name",
+                "long header value");
+  }
+
+  // check pipelined requests
+  CHECK_BATCH("GET /1 HTTP/1.1\r\n"
+              "Host: localhost\r\n"
+              "Content-Length: 0\r\n"
+              "\r\n"
+              "POST /2 HTTP/1.1\r\n"
+              "Content-Length: 4\r\n"
+              "\r\n"
+              "body"
+              "GET /3 HTTP/1.1\r\n"
+              "Content-Length: 0\r\n"
+              "\r\n"
+              "POST /4 HTTP/1.1\r\n"
+              "Transfer-Encoding: chunked\r\n"
+              "\r\n"
+              "4\r\nbody\r\n0\r\n\r\n"
+              "GET /5 HTTP/1.1\r\n"
+              "Content-Length: 0\r\n"
+              "\r\n",
+              2,
+              "/1 /2 /3 /4 /5 ");
+
+  // check methods and versions
+  CHECK_VERB("GET / HTTP/1.1\r\n\r\n", "GET", http::verb::get, 1, 1);
+  CHECK_VERB("PATCH /x HTTP/1.0\r\n\r\n", "PATCH", http::verb::patch, 1, 0);
+  CHECK_VERB("OPTIONS * HTTP/1.1\r\n\r\n",
+             "OPTIONS",
+             http::verb::options,
+             1,
+             1);
+  CHECK_VERB("GETS / HTTP/1.1\r\n\r\n", "GETS", http::verb::unknown, 1, 1);
+  CHECK_VERB("PURGE / HTTP/1.1\r\n\r\n", "PURGE", http::verb::unknown, 1, 1);
+  CHECK_VERB("PUT / HTTP/1.1\n\n", "PUT", http::verb::put, 1, 1);
+  CHECK_VERB("HEAD / HTTP/2.0\r\n\r\n", "HEAD", http::verb::head, 2, 0);
+  CHECK_VERB("DELETE /  HTTP/1.1\r\n\r\n", "DELETE", http::verb::delete_, 1, 1);
+  CHECK_FRAGMENTED("CONNECT www.example.com:80 HTTP/1.0\r\n"
+                   "\r\n");
+
+  // check limits
+  CHECK_LIMIT(request_line,
+              16,
+              "GET /very/long/target HTTP/1.1\r\n"
+              "\r\n",
+              http::parse_error::request_line_too_long);
+  CHECK_LIMIT(request_line,
+              16,
+              "GET http://localhost:8000/target HTTP/1.1\r\n"
+              "\r\n",
+              http::parse_error::request_line_too_long);
+  CHECK_LIMIT(headers_count,
+              2,
+              "GET / HTTP/1.1\r\n"
+              "Host: localhost\r\n"
+              "Accept: */*\r\n"
+              "X-Third: 3\r\n"
+              "\r\n",
+              http::parse_error::too_many_headers);
+  CHECK_LIMIT(header_bytes,
+              16,
+              "GET / HTTP/1.1\r\n"
+              "X-Long: 0123456789abcdef\r\n"
+              "\r\n",
+              http::parse_error::headers_too_large);
+  CHECK_LIMIT(body,
+              4,
+              "POST / HTTP/1.1\r\n"
+              "Content-Length: 5\r\n"
+              "\r\n"
+              "hello",
+              http::parse_error::body_too_large);
+  CHECK_LIMIT(body,
+              4,
+              "POST / HTTP/1.1\r\n"
+              "Transfer-Encoding: chunked\r\n"
+              "\r\n"
+              "3\r\nhel\r\n"
+              "2\r\nlo\r\n"
+              "0\r\n"
+              "\r\n",
+              http::parse_error::body_too_large);
+  CHECK_LIMIT(body,
+              SIZE_MAX - 1,
+              "POST / HTTP/1.1\r\n"
+              "Content-Length: 100000000000000000000\r\n"
+              "\r\n",
+              http::parse_error::body_too_large);
+  CHECK_LIMIT(body,
+              SIZE_MAX - 1,
+              "POST / HTTP/1.1\r\n"
+              "Content-Length: 12a\r\n"
+              "\r\n",
+              http::parse_error::bad_request);
+  CHECK_LIMIT(body,
+              SIZE_MAX - 1,
+              "GET / HTTP/1.1\r\n"
+              "Invalid Header\r\n"
+              "\r\n",
+              http::parse_error::bad_request);
+  CHECK_LIMIT(body,
+              SIZE_MAX - 1,
+              "POST / HTTP/1.1\r\n"
+              "Content-Length: 5\r\n"
+              "Content-Length: 0\r\n"
+              "\r\n"
+              "hello",
+              http::parse_error::bad_request);
+  CHECK_POLICY(http::strict_request_parser,
+               "POST / HTTP/1.1\r\n"
+               "Content-Length: 0\r\n"
+               "Content-Length: 5\r\n"
+               "\r\n"
+               "hello",
+               false);
+  CHECK_POLICY(http::strict_request_parser,
+               "POST / HTTP/1.1\r\n"
+               "Content-Length: 5\r\n"
+               "Content-Length: 5\r\n"
+               "\r\n"
+               "hello",
+               true);
+
+  // check several Host headers, RFC 9112 3.2
+  CHECK_LIMIT(body,
+              SIZE_MAX - 1,
+              "GET / HTTP/1.1\r\n"
+              "Host: example.com\r\n"
+              "Host: example.org\r\n"
+              "\r\n",
+              http::parse_error::bad_request);
+  CHECK_POLICY(http::request_parser,
+               "GET http://example.com/a HTTP/1.1\r\n"
+               "Host: example.org\r\n"
+               "\r\n",
+               true);
+
+  // header block of lazy view is scanned at once, and line by line, if it
+  // contains multiline value
+  for (const char *hosts : {"GET / HTTP/1.1\r\n"
+                            "Host: example.com\r\n"
+                            "Host: example.org\r\n"
+                            "\r\n",
+                            "GET / HTTP/1.1\r\n"
+                            "Host: example.com\r\n"
+                            "X-Multiline: first\r\n"
+                            "  second\r\n"
+                            "\r\n"}) {
+    bool                    several = strstr(hosts, "example.org") != nullptr;
+    http::request_parser    lazy_parser;
+    http::lazy_request_view view;
+    if ((lazy_parser.parse(hosts, strlen(hosts), view) ==
+         http::request_parser::status::error) != several) {
+      std::cerr << "invalid count of Host headers in header block\n"
+                << hosts << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // check default limit of headers count, it matches capacity of view
+  for (size_t count : {http::request_view::max_headers,
+                       http::request_view::max_headers + 1}) {
+    std::string str = "GET / HTTP/1.1\r\n";
+    for (size_t i = 0; i < count; ++i) {
+      str += "X-" + std::to_string(i) + ": value\r\n";
+    }
+    str += "\r\n";
+    http::request_parser         count_parser;
+    http::request_view           view;
+    http::request_parser::status status =
+        count_parser.parse(str.data(), str.size(), view);
+    bool accepted = count <= http::request_view::max_headers;
+    if ((status == http::request_parser::status::done) != accepted ||
+        (accepted == false &&
+         count_parser.last_error() != http::parse_error::too_many_headers)) {
+      std::cerr << "invalid limit of headers count: " << count << ", error: "
+                << static_cast<int>(count_parser.last_error()) << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // check large body
+  {
+    const char        *str = "PUT / HTTP/1.1\r\n"
+                             "Content-Length: 5000000000\r\n"
+                             "\r\n";
+    http::request_view view;
+    if (parser.parse(str, strlen(str), view) !=
+            (http::request_parser::headers_done |
+             http::request_parser::in_complete) ||
+        view.content_length != 5000000000ull) {
+      std::cerr << "invalid content length: " << view.content_length
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+    parser.clear();
+  }
+
+  // check large header split between buffers, it is within default limits
+  {
+    std::string cookie(20000, 'c');
+    std::string str = "GET / HTTP/1.1\r\n"
+                      "Cookie: " +
+                      cookie + "\r\n\r\n";
+    http::request_parser         large_parser;
+    http::request_view           view;
+    http::request_parser::status status = http::request_parser::error;
+    char                         fragment[1000];
+    for (size_t offset = 0; offset < str.size(); offset += sizeof(fragment)) {
+      size_t size = std::min(sizeof(fragment), str.size() - offset);
+      memcpy(fragment, str.data() + offset, size);
+      status = large_parser.parse(fragment, size, view);
+      if (status == http::request_parser::status::error) {
+        break;
+      }
+    }
+    if (status != http::request_parser::status::done ||
+        view.header("Cookie") != cookie) {
+      std::cerr << "large header is not saved, error: "
+                << static_cast<int>(large_parser.last_error()) << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  {
+    std::string cookie(20000, 'c');
+    std::string str = "POST / HTTP/1.1\r\n"
+                      "Content-Length: 10\r\n"
+                      "Cookie: " +
+                      cookie + "\r\n\r\nhello";
+    http::request_parser large_parser;
+    http::request_view   view;
+    std::string          buffer = str;
+    auto                 first  = large_parser.parse(buffer.data(),
+                                        buffer.size(),
+                                        view);
+    buffer.assign(buffer.size(), 'x'); // next read reuses the buffer
+    buffer.replace(0, 5, "world");
+    auto second = large_parser.parse(buffer.data(), 5, view);
+    if (first != (http::request_parser::headers_done |
+                  http::request_parser::in_complete) ||
+        second != http::request_parser::status::done ||
+        view.header("Cookie") != cookie || view.body != "world") {
+      std::cerr << "headers of request with split body are not saved, error: "
+                << static_cast<int>(large_parser.last_error()) << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // check lazy headers
+  CHECK_LAZY("GET /index.html HTTP/1.1\r\n"
+             "Host: example.com\r\n"
+             "Accept:  text/html \r\n"
+             "X-Custom: a:b\r\n"
+             "Connection: Keep-Alive\r\n"
+             "\r\n",
+             true);
+  CHECK_LAZY("POST /form HTTP/1.1\r\n"
+             "content-length: 5\r\n"
+             "Cookie: a=b\r\n"
+             "Cookie: c=d\r\n"
+             "\r\n"
+             "hello",
+             true);
+  CHECK_LAZY("GET http://localhost:8000/blah HTTP/1.1\r\n"
+             "Accept: */*\r\n"
+             "\r\n",
+             true);
+  CHECK_LAZY("GET / HTTP/1.1\n"
+             "Host: example.com\n"
+             "Accept: */*\n"
+             "\n",
+             false);
+  CHECK_LAZY("GET / HTTP/1.1\r\n"
+             "Host: example.com\r\n"
+             "X-Multiline: first\r\n"
+             "  second\r\n"
+             "\r\n",
+             false);
+  CHECK_LAZY("GET / HTTP/1.1\r\n"
+             "\r\n",
+             false);
+  {
+    // fields of previous request are in freed buffer or in spill, so they
+    // must not be saved, when next request is split inside its method
+    const char *parts[] = {"GET /a HTTP/1.1\r\n",
+                           "\r\n",
+                           "GE",
+                           "T /b HTTP/1.1\r\n\r\n",
+                           "PUT /c HTTP/1.1\r\n\r\n",
+                           "PO",
+                           "ST /d HTTP/1.1\r\n\r\n"};
+    const char *targets[] = {"", "/a", "", "/b", "/c", "", "/d"};
+    http::lazy_request_view view;
+    http::request_parser    lazy_parser;
+    for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); ++i) {
+      std::unique_ptr<char[]> buffer{new char[strlen(parts[i])]};
+      memcpy(buffer.get(), parts[i], strlen(parts[i]));
+      http::request_parser::status status =
+          lazy_parser.parse(buffer.get(), strlen(parts[i]), view);
+      bool done = status == http::request_parser::status::done;
+      if (done != (targets[i][0] != '\0') ||
+          (done && view.target != targets[i])) {
+        std::cerr << "fields of previous lazy request are saved, part: " << i
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  {
+    const char *str = "POST / HTTP/1.1\r\n"
+                      "Transfer-Encoding: chunked\r\n"
+                      "Content-Length: 100\r\n"
+                      "\r\n"
+                      "5\r\nhello\r\n"
+                      "0\r\n"
+                      "Trailer: value\r\n"
+                      "\r\n";
+    http::lazy_request_view      view;
+    http::request_parser::status status = http::request_parser::error;
+    std::string                  body;
+    size_t                       parsed = 0;
+    for (size_t offset = 0; offset < strlen(str); offset += parsed) {
+      status = parser.parse(str + offset, strlen(str) - offset, view, &parsed);
+      body.append(view.body);
+    }
+    if (status != http::request_parser::status::done || view.chunked == false ||
+        body != "hello" || view.header("Trailer") != "value" ||
+        view.header(http::field::content_length) != "100") {
+      std::cerr << "invalid lazy chunked request, body: " << body << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  {
+    http::parser_limits limits;
+    limits.headers_count = 1;
+    http::request_parser limited{
+        http::request_parser::default_spill_capacity, limits};
+    http::lazy_request_view view;
+    const char             *str = "GET / HTTP/1.1\r\n"
+                                  "Host: example.com\r\n"
+                                  "Accept: */*\r\n"
+                                  "\r\n";
+    if (limited.parse(str, strlen(str), view) != http::request_parser::error ||
+        limited.last_error() != http::parse_error::too_many_headers) {
+      std::cerr << "limits are not checked for header block" << std::endl;
+      return EXIT_FAILURE;
+    }
+    str = "POST / HTTP/1.1\r\n"
+          "Content-Length: 1x\r\n"
+          "\r\n";
+    if (limited.parse(str, strlen(str), view) != http::request_parser::error ||
+        limited.last_error() != http::parse_error::bad_request) {
+      std::cerr << "framing is not checked for header block" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // check percent decoding
+  CHECK_DECODE("", false, "");
+  CHECK_DECODE("/plain/path", false, "/plain/path");
+  CHECK_DECODE("/a%20b/%2Fc%2f", false, "/a b//c/");
+  CHECK_DECODE("a+b%2B", false, "a+b+");
+  CHECK_DECODE("a+b%2B", true, "a b+");
+  CHECK_DECODE("%e2%82%AC", false, "\xe2\x82\xac");
+  CHECK_DECODE("/very/long/path/which/is/longer/then/32/octets%21/and/"
+               "contains/escapes/at/the/end%20of/simd/chunks/%3f",
+               false,
+               "/very/long/path/which/is/longer/then/32/octets!/and/"
+               "contains/escapes/at/the/end of/simd/chunks/?");
+  CHECK_DECODE("bad%2", false, "");
+  CHECK_DECODE("bad%zz/long/path/which/is/longer/then/32/octets",
+               false,
+               "");
+
+  // check index of target
+  CHECK_TARGET("/", "/", "", "|", "");
+  CHECK_TARGET("/a/b%20c/", "/a/b%20c/", "", "a|b%20c||", "");
+  CHECK_TARGET("/search?q=a+b&&lang=en&flag#top",
+               "/search",
+               "q=a+b&&lang=en&flag",
+               "search|",
+               "q=a+b|lang=en|flag=|");
+  CHECK_TARGET("http://example.com:80/a/b?x=1",
+               "/a/b",
+               "x=1",
+               "a|b|",
+               "x=1|");
+  CHECK_TARGET("http://example.com?x=1", "", "x=1", "", "x=1|");
+  CHECK_TARGET("*", "*", "", "", "");
+  {
+    http::request_view view;
+    const char        *str = "GET http://example.com/a?x=%41 HTTP/1.1\r\n"
+                             "\r\n";
+    parser.parse(str, strlen(str), view);
+    http::target_view target{view.target};
+    char              decoded[16];
+    size_t            size = http::percent_decode(target.param("x"), decoded);
+    if (view.header(http::field::host) != "example.com" ||
+        target.segment(0) != "a" ||
+        std::string_view(decoded, size) != "A" ||
+        target.param("missing").empty() == false) {
+      std::cerr << "invalid index of absolute target" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::string many = "/";
+    for (size_t i = 0; i <= http::target_view::max_segments; ++i) {
+      many.append("s/");
+    }
+    if (http::target_view{many}.truncated() == false ||
+        http::target_view{"/a?b"}.truncated()) {
+      std::cerr << "invalid truncation of target index" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // check policies
+  CHECK_POLICY(http::strict_request_parser,
+               "GET /index.html HTTP/1.1\r\n"
+               "Host: example.com\r\n"
+               "\r\n",
+               true);
+  CHECK_POLICY(http::strict_request_parser,
+               "POST / HTTP/1.1\r\n"
+               "Transfer-Encoding: chunked\r\n"
+               "\r\n"
+               "5;ext=1\r\nhello\r\n"
+               "0\r\n"
+               "\r\n",
+               true);
+  for (const char *str : {"GET / HTTP/1.1\n"
+                          "Host: example.com\r\n"
+                          "\r\n",
+                          "GET / HTTP/1.1\r\n"
+                          "Host: example.com\n"
+                          "\r\n",
+                          "GET / HTTP/1.1\r\n"
+                          "Host: example.com\r\n"
+                          "\n",
+                          "GET\t/ HTTP/1.1\r\n"
+                          "\r\n",
+                          "GET  / HTTP/1.1\r\n"
+                          "\r\n",
+                          "GET / HTTP/1.1\r\n"
+                          "X-Multiline: first\r\n"
+                          "  second\r\n"
+                          "\r\n",
+                          "POST / HTTP/1.1\r\n"
+                          "Transfer-Encoding: chunked\r\n"
+                          "\r\n"
+                          "5\nhello\r\n"
+                          "0\r\n"
+                          "\r\n",
+                          "POST / HTTP/1.1\r\n"
+                          "Transfer-Encoding: chunked\r\n"
+                          "\r\n"
+                          "5 ;ext=1\r\nhello\r\n"
+                          "0\r\n"
+                          "\r\n"}) {
+    CHECK_POLICY(http::strict_request_parser, str, false);
+    CHECK_POLICY(http::request_parser, str, true);
+  }
+  CHECK_POLICY(http::strict_request_parser,
+               "POST / HTTP/1.1\r\n"
+               "Transfer-Encoding: chunked\r\n"
+               "\r\n"
+               "zz\r\n"
+               "\r\n",
+               false);
+  // final transfer coding of request must be chunked, RFC 9112 6.3
+  for (const char *str : {"POST / HTTP/1.1\r\n"
+                          "Transfer-Encoding: gzip\r\n"
+                          "Content-Length: 5\r\n"
+                          "\r\n"
+                          "hello",
+                          "POST / HTTP/1.1\r\n"
+                          "Transfer-Encoding: chunked\r\n"
+                          "Transfer-Encoding: gzip\r\n"
+                          "\r\n"
+                          "5\r\nhello\r\n"
+                          "0\r\n"
+                          "\r\n",
+                          "POST / HTTP/1.1\r\n"
+                          "Transfer-Encoding: chunked, gzip\r\n"
+                          "\r\n"}) {
+    CHECK_POLICY(http::strict_request_parser, str, false);
+    CHECK_POLICY(http::request_parser, str, false);
+  }
+  CHECK_POLICY(http::request_parser,
+               "POST / HTTP/1.1\r\n"
+               "Transfer-Encoding: gzip\r\n"
+               "Transfer-Encoding: chunked\r\n"
+               "\r\n"
+               "0\r\n"
+               "\r\n",
+               true);
+  CHECK_POLICY(http::strict_request_parser,
+               "POST / HTTP/1.1\r\n"
+               "Transfer-Encoding: chunked\r\n"
+               "Content-Length: 5\r\n"
+               "\r\n"
+               "0\r\n"
+               "\r\n",
+               false);
+  CHECK_POLICY(http::request_parser,
+               "POST / HTTP/1.1\r\n"
+               "Transfer-Encoding: chunked\r\n"
+               "Content-Length: 5\r\n"
+               "\r\n"
+               "0\r\n"
+               "\r\n",
+               true);
+  CHECK_POLICY(origin_parser, "OPTIONS * HTTP/1.1\r\n\r\n", true);
+  CHECK_POLICY(origin_parser, "GET /a HTTP/1.1\r\n\r\n", true);
+  CHECK_POLICY(origin_parser, "GET http://a/b HTTP/1.1\r\n\r\n", false);
+  CHECK_POLICY(origin_parser, "CONNECT a:443 HTTP/1.1\r\n\r\n", false);
+  {
+    const char *str = "GET /a HTTP/1.1\r\n"
+                      "\r\n"
+                      "GET /b HTTP/1.1\r\n"
+                      "\r\n";
+    http::strict_request_parser        strict_parser;
+    http::request_view                 reqs[2];
+    http::strict_request_parser::batch res =
+        strict_parser.parse_batch(str, strlen(str), reqs, 2);
+    if (res.count != 2 || res.parsed != strlen(str) || reqs[0].body != "" ||
+        reqs[1].target != "/b") {
+      std::cerr << "request without Content-Length must have no body: "
+                << res.count << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  {
+    const char *str = "POST http://example.com/a HTTP/1.1\r\n"
+                      "Accept: */*\r\n"
+                      "Content-Length: 5\r\n"
+                      "\r\n"
+                      "hello";
+    for (size_t step : {strlen(str), size_t{7}}) {
+      http::basic_request_parser<skip_policy> skip_parser;
+      http::request_view                      view;
+      http::request_parser::status            status =
+          http::request_parser::error;
+      for (size_t offset = 0; offset < strlen(str); offset += step) {
+        size_t size = std::min(step, strlen(str) - offset);
+        status      = skip_parser.parse(str + offset, size, view);
+      }
+      if (status != http::request_parser::status::done ||
+          view.headers_count != 0 || view.content_length != 5 ||
+          view.target != "/a") {
+        std::cerr << "headers must be skipped, fragment size: " << step
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // check body sink
+  {
+    std::string body;
+    for (size_t i = 0; body.size() < 200000; ++i) {
+      body.append(std::to_string(i)).append(" ");
+    }
+    body.resize(200000);
+    std::string head = "PUT /upload HTTP/1.1\r\n"
+                       "Content-Length: 200000\r\n"
+                       "\r\n" +
+                       body.substr(0, 1000);
+
+    int   sockets[2];
+    FILE *file = tmpfile();
+    if (file == NULL || socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+      std::cerr << "can not create file or sockets" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    http::request_view           view;
+    http::request_parser::status status =
+        parser.parse(head.data(), head.size(), view);
+    http::body_sink sink{fileno(file)};
+    if (status != (http::request_parser::headers_done |
+                   http::request_parser::in_complete) ||
+        sink.write(view.body) == false ||
+        parser.body_left() != body.size() - 1000) {
+      std::cerr << "invalid start of body" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // rest of body is written to socket by parts, as it comes from network
+    for (size_t offset = 1000; parser.body_left() != 0;) {
+      size_t size = std::min<size_t>(body.size() - offset, 30000);
+      if (size != 0 &&
+          write(sockets[1], body.data() + offset, size) !=
+              static_cast<ssize_t>(size)) {
+        std::cerr << "can not write to socket" << std::endl;
+        return EXIT_FAILURE;
+      }
+      offset += size;
+
+      ssize_t moved = sink.transfer(sockets[0], parser.body_left());
+      if (moved <= 0) {
+        std::cerr << "can not transfer body" << std::endl;
+        return EXIT_FAILURE;
+      }
+      status = parser.skip_body(moved);
+    }
+
+    std::string written(body.size(), '\0');
+    if (status != http::request_parser::done ||
+        pread(fileno(file), written.data(), written.size(), 0) !=
+            static_cast<ssize_t>(body.size()) ||
+        written != body) {
+      std::cerr << "body is not transferred" << std::endl;
+      return EXIT_FAILURE;
+    }
+    close(sockets[0]);
+    close(sockets[1]);
+    fclose(file);
+  }
+  {
+    // destination is full pipe, so octets read from socket must be kept
+    int sockets[2];
+    int full[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sockets) != 0 ||
+        pipe2(full, O_NONBLOCK) != 0) {
+      std::cerr << "can not create pipe or sockets" << std::endl;
+      return EXIT_FAILURE;
+    }
+    char filler[4096] = {};
+    while (write(full[1], filler, sizeof(filler)) > 0) {
+    }
+
+    http::body_sink sink{full[1]};
+    ssize_t         blocked = -1;
+    if (write(sockets[1], "hello", 5) == 5) {
+      blocked = sink.transfer(sockets[0], 5);
+    }
+    int blocked_errno = errno;
+    while (read(full[0], filler, sizeof(filler)) > 0) {
+    }
+    ssize_t moved = sink.transfer(sockets[0], 5);
+    char    data[5];
+    if (blocked != -1 || blocked_errno != EAGAIN || moved != 5 ||
+        read(full[0], data, sizeof(data)) != 5 ||
+        std::string_view(data, sizeof(data)) != "hello") {
+      std::cerr << "body is lost, when destination can not accept it"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+    close(sockets[0]);
+    close(sockets[1]);
+    close(full[0]);
+    close(full[1]);
+  }
+  {
+    http::request_view view;
+    const char        *parts[] = {"POST / HTTP/1.1\r\n"
+                                  "Transfer-Encoding: chunked\r\n"
+                                  "\r\n",
+                                  "a\r\n",
+                                  "\r\n0\r\n\r\n"};
+    http::request_parser::status status =
+        parser.parse(parts[0], strlen(parts[0]), view);
+    status = parser.parse(parts[1], strlen(parts[1]), view);
+    if (parser.body_left() != 10 ||
+        parser.skip_body(10) != (http::request_parser::headers_done |
+                                 http::request_parser::in_complete)) {
+      std::cerr << "chunk data can not be skipped" << std::endl;
+      return EXIT_FAILURE;
+    }
+    status = parser.parse(parts[2], strlen(parts[2]), view);
+    if (status != http::request_parser::done) {
+      std::cerr << "chunked message is not finished after skipped chunk"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // check stats
+  {
+    const char *valid = "GET / HTTP/1.1\r\n"
+                        "Content-Length: 0\r\n"
+                        "\r\n"
+                        "POST / HTTP/1.1\r\n"
+                        "Content-Length: 2\r\n"
+                        "\r\n"
+                        "ok";
+    const char *invalid = "GET / HTTP/1.1\r\n"
+                          "Bad Header\r\n"
+                          "\r\n";
+
+    http::stats::snapshot before = http::stats::collect();
+    std::thread           worker{[valid, invalid] {
+      http::basic_request_parser<stats_policy> stats_parser;
+      http::request_view                       view;
+      size_t                                   parsed = 0;
+      for (size_t offset = 0; offset < strlen(valid); offset += parsed) {
+        stats_parser.parse(
+            valid + offset, strlen(valid) - offset, view, &parsed);
+      }
+      stats_parser.parse(invalid, strlen(invalid), view);
+    }};
+    worker.join();
+    http::stats::snapshot after = http::stats::collect();
+
+    size_t bad_request = static_cast<size_t>(http::parse_error::bad_request);
+    size_t space       = static_cast<size_t>(http::stats::octet_class::space);
+    uint64_t cycles = 0;
+    for (size_t i = 0; i < http::stats::phase_count; ++i) {
+      cycles += after.cycles[i] - before.cycles[i];
+    }
+    if (after.requests - before.requests != 2 ||
+        after.bytes - before.bytes != strlen(valid) + 19 ||
+        after.errors[bad_request] - before.errors[bad_request] != 1 ||
+        after.error_states[http::request_parser::header_key][space] -
+                before.error_states[http::request_parser::header_key][space] !=
+            1 ||
+        after.headers_count[1] - before.headers_count[1] != 2 ||
+        cycles == 0) {
+      std::cerr << "invalid stats, requests: "
+                << after.requests - before.requests
+                << ", bytes: " << after.bytes - before.bytes << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // default parser doesn't collect stats
+    http::request_view view;
+    parser.parse(valid, strlen(valid), view);
+    if (http::stats::collect().requests != after.requests) {
+      std::cerr << "stats are collected by default parser" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // check suspend, every part of connection is parsed by other parser, which
+  // is resumed from compact state
+  for (const char *str : {"POST /a HTTP/1.1\r\n"
+                          "Content-Length: 11\r\n"
+                          "\r\n"
+                          "hello world",
+                          "POST /a HTTP/1.1\r\n"
+                          "Transfer-Encoding: chunked\r\n"
+                          "\r\n"
+                          "5\r\nhello\r\n"
+                          "6\r\n world\r\n"
+                          "0\r\n"
+                          "\r\n"}) {
+    for (size_t split = 1; split < strlen(str); ++split) {
+      http::request_parser         first;
+      http::request_parser         second;
+      http::request_parser        *current = &first;
+      http::request_view           view;
+      std::string                  body;
+      http::request_parser::status status = http::request_parser::error;
+      size_t                       parsed = 0;
+      for (size_t offset = 0; offset < strlen(str); offset += parsed) {
+        if (offset == split) {
+          if (first.suspendable() == false) {
+            break; // request line or headers are not complete
+          }
+          http::parser_state state = first.suspend();
+          second.resume(state);
+          current = &second;
+        }
+
+        size_t end = offset < split ? split : strlen(str);
+        status     = current->parse(str + offset, end - offset, view, &parsed);
+        body.append(view.body);
+        if (status == http::request_parser::error) {
+          break;
+        }
+      }
+      if (current == &first) {
+        continue;
+      }
+      if (status != http::request_parser::done || body != "hello world" ||
+          second.idle() == false) {
+        std::cerr << "request is not resumed, split: " << split << ", body: "
+                  << body << "\n"
+                  << str << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  {
+    http::request_parser suspended;
+    http::request_view   view;
+    const char          *str = "GET / HTTP/1.1\r\nHost: a";
+    if (suspended.suspendable() == false || suspended.idle() == false ||
+        suspended.parse(str, strlen(str), view) !=
+            http::request_parser::in_complete ||
+        suspended.suspendable()) {
+      std::cerr << "parser with incomplete headers can not be suspended"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // check forwarding, unchanged parts of request point to the buffer
+  {
+    http::forward_serializer forward;
+    CHECK_FORWARD(forward,
+                  "GET /a HTTP/1.1\r\n"
+                  "Host: example.com\r\n"
+                  "Accept: */*\r\n"
+                  "\r\n",
+                  "GET /a HTTP/1.1\r\n"
+                  "Host: example.com\r\n"
+                  "Accept: */*\r\n"
+                  "\r\n");
+    CHECK_FORWARD(forward,
+                  "GET /a HTTP/1.0\n"
+                  "Host: example.com\n"
+                  "Accept: */*\n"
+                  "\n",
+                  "GET /a HTTP/1.0\r\n"
+                  "Host: example.com\r\n"
+                  "Accept: */*\r\n"
+                  "\r\n");
+
+    forward.remove("x-remove");
+    forward.remove("Proxy-Authorization");
+    forward.set("Accept", "text/html");
+    forward.add("X-Forwarded-For", "10.0.0.1");
+    CHECK_FORWARD(forward,
+                  "GET /a HTTP/1.1\r\n"
+                  "Host: example.com\r\n"
+                  "X-Remove: 1\r\n"
+                  "Accept: */*\r\n"
+                  "Proxy-Authorization: Basic dXNlcg==\r\n"
+                  "X-Keep: 2\r\n"
+                  "\r\n",
+                  "GET /a HTTP/1.1\r\n"
+                  "Host: example.com\r\n"
+                  "X-Keep: 2\r\n"
+                  "Accept: text/html\r\n"
+                  "X-Forwarded-For: 10.0.0.1\r\n"
+                  "\r\n");
+
+    // absolute form target is split to origin form and Host
+    forward.clear();
+    CHECK_FORWARD(forward,
+                  "GET http://example.com:8080/p?q=1 HTTP/1.1\r\n"
+                  "Host: other\r\n"
+                  "Accept: */*\r\n"
+                  "\r\n",
+                  "GET /p?q=1 HTTP/1.1\r\n"
+                  "Host: example.com:8080\r\n"
+                  "Accept: */*\r\n"
+                  "\r\n");
+    CHECK_FORWARD(forward,
+                  "GET http://example.com HTTP/1.1\r\n"
+                  "\r\n",
+                  "GET / HTTP/1.1\r\n"
+                  "Host: example.com\r\n"
+                  "\r\n");
+    CHECK_FORWARD(forward,
+                  "GET /a HTTP/1.1\r\n"
+                  "Host: example.com\r\n"
+                  "\r\n",
+                  "GET /a HTTP/1.1\r\n"
+                  "Host: example.com\r\n"
+                  "\r\n");
+
+    // request without edits is one span of the buffer, except end of headers
+    const char request[] = "POST /a HTTP/1.1\r\n"
+                           "Host: example.com\r\n"
+                           "X-Remove: 1\r\n"
+                           "Content-Length: 4\r\n"
+                           "\r\n"
+                           "body";
+    http::request_parser parser;
+    http::request_view   view;
+    iovec                iov[8];
+    forward.clear();
+    forward.remove("X-Remove");
+    forward.add("Via", "1.1 proxy");
+    if (parser.parse(request, strlen(request), view) !=
+            http::request_parser::status::done ||
+        forward.serialize(view, request, iov, 8) != 4 ||
+        iov[0].iov_base != request || iov[3].iov_base != view.body.data() ||
+        forward.serialize(view, request, iov, 3) != 0) {
+      std::cerr << "request is not forwarded from its buffer" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // separators are taken only from the last buffer, fields saved in spill
+    // are separated by canonical ones
+    const char split[] = "GET /a HTTP/1.1\r\n"
+                         "Host:example.com\r\n"
+                         "Accept:*/*\r\n"
+                         "\r\n";
+
+    const char *expected[] = {"GET /a HTTP/1.1\r\n"
+                              "Host: example.com\r\n"
+                              "Accept:*/*\r\n"
+                              "\r\n",
+                              "GET /a HTTP/1.1\r\n"
+                              "Host: example.com\r\n"
+                              "Accept: */*\r\n"
+                              "\r\n"};
+    char   first[sizeof(split)];
+    char   second[sizeof(split)];
+    size_t middle = strstr(split, "example") + 4 - split;
+    memcpy(first, split, middle);
+    memcpy(second, split + middle, strlen(split) - middle);
+    forward.clear();
+    view.reset();
+    parser.parse(first, middle, view);
+    if (parser.parse(second, strlen(split) - middle, view) !=
+        http::request_parser::status::done) {
+      std::cerr << "split request is not parsed" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::string_view buffers[] = {
+        std::string_view{second, strlen(split) - middle}, std::string_view{}};
+    iovec            spans[16];
+    for (size_t i = 0; i < 2; ++i) {
+      size_t      count = forward.serialize(view, buffers[i], spans, 16);
+      std::string forwarded;
+      for (size_t j = 0; j < count; ++j) {
+        forwarded.append(static_cast<const char *>(spans[j].iov_base),
+                         spans[j].iov_len);
+      }
+      if (forwarded != expected[i]) {
+        std::cerr << "invalid separators of forwarded request\n"
+                  << forwarded << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // check response parser, every response is parsed by fragments of any size
+  {
+    CHECK_RESPONSE(http::verb::get,
+                   "HTTP/1.1 200 OK\r\n"
+                   "Content-Length: 4\r\n"
+                   "\r\n"
+                   "body",
+                   200,
+                   "OK",
+                   "body");
+    CHECK_RESPONSE(http::verb::get,
+                   "HTTP/1.0 404 Not Found\r\n"
+                   "Content-Length: 0\r\n"
+                   "\r\n",
+                   404,
+                   "Not Found",
+                   "");
+    CHECK_RESPONSE(http::verb::get,
+                   "HTTP/1.1 204\r\n"
+                   "\r\n",
+                   204,
+                   "",
+                   "");
+    CHECK_RESPONSE(http::verb::post,
+                   "HTTP/1.1 200 OK\r\n"
+                   "Transfer-Encoding: chunked\r\n"
+                   "\r\n"
+                   "4\r\n"
+                   "Wiki\r\n"
+                   "5\r\n"
+                   "pedia\r\n"
+                   "0\r\n"
+                   "\r\n",
+                   200,
+                   "OK",
+                   "Wikipedia");
+    CHECK_RESPONSE(http::verb::get,
+                   "HTTP/1.0 200 OK\r\n"
+                   "Server: test\r\n"
+                   "\r\n"
+                   "to the end",
+                   200,
+                   "OK",
+                   "to the end");
+    CHECK_RESPONSE(http::verb::get,
+                   "HTTP/1.1 500 Internal  Server Error \r\n"
+                   "Content-Length: 1\r\n"
+                   "\r\n"
+                   "!",
+                   500,
+                   "Internal  Server Error",
+                   "!");
+    CHECK_RESPONSE(http::verb::get,
+                   "HTTP/1.1 200 OK\n"
+                   "Content-Length: 2\n"
+                   "\n"
+                   "ok",
+                   200,
+                   "OK",
+                   "ok");
+    // responses without body, Content-Length describes selected representation
+    CHECK_RESPONSE(http::verb::head,
+                   "HTTP/1.1 200 OK\r\n"
+                   "Content-Length: 10\r\n"
+                   "\r\n",
+                   200,
+                   "OK",
+                   "");
+    CHECK_RESPONSE(http::verb::get,
+                   "HTTP/1.1 304 Not Modified\r\n"
+                   "Content-Length: 10\r\n"
+                   "\r\n",
+                   304,
+                   "Not Modified",
+                   "");
+    CHECK_RESPONSE(http::verb::get,
+                   "HTTP/1.1 204 No Content\r\n"
+                   "\r\n",
+                   204,
+                   "No Content",
+                   "");
+    CHECK_RESPONSE(http::verb::connect,
+                   "HTTP/1.1 200 Connection Established\r\n"
+                   "\r\n",
+                   200,
+                   "Connection Established",
+                   "");
+    CHECK_RESPONSE(http::verb::get,
+                   "HTTP/1.1 101 Switching Protocols\r\n"
+                   "Upgrade: websocket\r\n"
+                   "\r\n",
+                   101,
+                   "Switching Protocols",
+                   "");
+    // transfer coding other then chunked is finished by close
+    CHECK_RESPONSE(http::verb::get,
+                   "HTTP/1.1 200 OK\r\n"
+                   "Transfer-Encoding: gzip\r\n"
+                   "Content-Length: 2\r\n"
+                   "\r\n"
+                   "to the end",
+                   200,
+                   "OK",
+                   "to the end");
+
+    CHECK_RESPONSE_ERROR(http::response_parser, "HTTP/1.1 20 OK\r\n\r\n");
+    CHECK_RESPONSE_ERROR(http::response_parser, "HTTP/1.1 2000 OK\r\n\r\n");
+    CHECK_RESPONSE_ERROR(http::response_parser, "HTTP/1.1 2x0 OK\r\n\r\n");
+    CHECK_RESPONSE_ERROR(http::response_parser, "HTTP/1.1\r\n\r\n");
+    CHECK_RESPONSE_ERROR(http::response_parser, "HTTP/1. 200 OK\r\n\r\n");
+    CHECK_RESPONSE_ERROR(http::response_parser, "HTP/1.1 200 OK\r\n\r\n");
+    CHECK_RESPONSE_ERROR(http::response_parser, "GET / HTTP/1.1\r\n\r\n");
+    CHECK_RESPONSE_ERROR(http::response_parser,
+                         "HTTP/1.1 200 OK\r\n"
+                         "Content-Length: x\r\n"
+                         "\r\n");
+    CHECK_RESPONSE_ERROR(http::strict_response_parser,
+                         "HTTP/1.1  200 OK\r\n\r\n");
+    CHECK_RESPONSE_ERROR(http::strict_response_parser,
+                         "HTTP/1.1 200 OK\n\n");
+
+    // interim response keeps method of request, so final response to HEAD
+    // has no body, and next response is framed by its own headers
+    const char responses[] = "HTTP/1.1 100 Continue\r\n"
+                             "\r\n"
+                             "HTTP/1.1 200 OK\r\n"
+                             "Content-Length: 4\r\n"
+                             "\r\n"
+                             "HTTP/1.1 200 OK\r\n"
+                             "Content-Length: 4\r\n"
+                             "\r\n"
+                             "body";
+    http::response_parser         parser;
+    http::response_view           res;
+    http::response_parser::status status[3];
+    size_t                        parsed[3] = {};
+    size_t                        offset    = 0;
+    parser.request_method(http::verb::head);
+    for (size_t i = 0; i < 3; ++i) {
+      status[i] = parser.parse(responses + offset,
+                               strlen(responses) - offset,
+                               res,
+                               &parsed[i]);
+      offset += parsed[i];
+    }
+    if (status[0] != http::response_parser::done ||
+        status[1] != http::response_parser::done ||
+        status[2] != http::response_parser::done ||
+        offset != strlen(responses) || res.body != "body") {
+      std::cerr << "invalid framing of pipelined responses" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // connection is closed before end of body
+    const char truncated[] = "HTTP/1.1 200 OK\r\n"
+                             "Content-Length: 10\r\n"
+                             "\r\n"
+                             "body";
+    if (parser.parse(truncated, strlen(truncated), res) !=
+            (http::response_parser::headers_done |
+             http::response_parser::in_complete) ||
+        parser.finish() != http::response_parser::error ||
+        parser.finish() != http::response_parser::in_complete) {
+      std::cerr << "truncated response is accepted" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // HTTP/1.1 connection is persistent, unless it is closed by header
+    struct {
+      const char *str;
+      bool        keep_alive;
+    } persistence[] = {{"HTTP/1.1 200 OK\r\n"
+                        "Content-Length: 0\r\n"
+                        "\r\n",
+                        true},
+                       {"HTTP/1.1 200 OK\r\n"
+                        "Connection: close\r\n"
+                        "Content-Length: 0\r\n"
+                        "\r\n",
+                        false},
+                       {"HTTP/1.1 200 OK\r\n"
+                        "Connection: Upgrade, Close\r\n"
+                        "Content-Length: 0\r\n"
+                        "\r\n",
+                        false},
+                       {"HTTP/1.0 200 OK\r\n"
+                        "Content-Length: 0\r\n"
+                        "\r\n",
+                        false},
+                       {"HTTP/1.0 200 OK\r\n"
+                        "Connection: keep-alive\r\n"
+                        "Content-Length: 0\r\n"
+                        "\r\n",
+                        true}};
+    for (const auto &item : persistence) {
+      for (size_t step : {strlen(item.str), size_t{1}}) {
+        http::response_parser         res_parser;
+        http::response_parser::status res_status = http::response_parser::error;
+        size_t                        res_parsed = 0;
+        for (size_t offset = 0; offset < strlen(item.str);
+             offset += res_parsed) {
+          size_t size = std::min(step, strlen(item.str) - offset);
+          res_status  = res_parser.parse(
+              item.str + offset, size, res, &res_parsed);
+          if (res_status == http::response_parser::error) {
+            break;
+          }
+        }
+        if (res_status != http::response_parser::done ||
+            res.keep_alive != item.keep_alive) {
+          std::cerr << "invalid persistence of connection, fragment size: "
+                    << step << "\n"
+                    << item.str << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // body delimited by close is limited as any other body
+    http::parser_limits limits;
+    limits.body = 8;
+    http::response_parser limited{http::response_parser::default_spill_capacity,
+                                  limits};
+    const char endless[] = "HTTP/1.1 200 OK\r\n"
+                           "\r\n"
+                           "0123456789";
+    if (limited.parse(endless, strlen(endless), res) !=
+            http::response_parser::error ||
+        limited.last_error() != http::parse_error::body_too_large) {
+      std::cerr << "body delimited by close is not limited" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // request and response keep headers in message_view, both save them and
+    // their start line, when every octet is received to the same buffer
+    const char request_text[]  = "GET /a HTTP/1.1\r\n"
+                                 "Host: example.com\r\n"
+                                 "X-Id: 42\r\n"
+                                 "\r\n";
+    const char response_text[] = "HTTP/1.1 404 Not Found\r\n"
+                                 "Content-Length: 0\r\n"
+                                 "X-Id: 42\r\n"
+                                 "\r\n";
+    http::request_parser  req_parser;
+    http::request_view    req;
+    http::response_parser res_parser;
+    char                  octet    = '\0';
+    bool                  req_done = false;
+    bool                  res_done = false;
+    for (char ch : std::string_view{request_text}) {
+      octet    = ch;
+      req_done = req_parser.parse(&octet, 1, req) == http::request_parser::done;
+    }
+    for (char ch : std::string_view{response_text}) {
+      octet    = ch;
+      res_done = res_parser.parse(&octet, 1, res) ==
+                 http::response_parser::done;
+    }
+    const http::message_view *messages[] = {&req, &res};
+    for (const http::message_view *msg : messages) {
+      if (msg->headers_count != 2 || msg->header("X-Id") != "42" ||
+          msg->major != 1 || msg->minor != 1) {
+        std::cerr << "headers of message are not saved" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    if (req_done == false || res_done == false || req.target != "/a" ||
+        req.header(http::field::host) != "example.com" ||
+        res.status_code != 404 || res.reason != "Not Found") {
+      std::cerr << "start line of message is not saved: " << req.target << " "
+                << res.reason << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    res.reset();
+    if (res.headers_count != 0 || res.header("X-Id").empty() == false ||
+        res.status_code != 0 || res.reason.empty() == false) {
+      std::cerr << "response is not reset" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+#if __cplusplus >= 202002L
+  // check coroutine reader, requests are read by fragments of any size, so
+  // reader is resumed inside every token
+  {
+    const char requests[] = "GET /a HTTP/1.1\r\n"
+                            "Host: example.com\r\n"
+                            "\r\n"
+                            "POST /b HTTP/1.1\r\n"
+                            "Content-Length: 4\r\n"
+                            "\r\n"
+                            "body"
+                            "POST /c HTTP/1.1\r\n"
+                            "Transfer-Encoding: chunked\r\n"
+                            "\r\n"
+                            "4\r\n"
+                            "Wiki\r\n"
+                            "5\r\n"
+                            "pedia\r\n"
+                            "0\r\n"
+                            "\r\n"
+                            "DELETE /d HTTP/1.1\r\n"
+                            "\r\n";
+    CHECK_READER(requests,
+                 4096,
+                 true,
+                 "GET /a \nPOST /b body\nPOST /c Wikipedia\nDELETE /d \n",
+                 http::parse_error::none);
+    // buffer is smaller then request, so fields are kept by the parser
+    CHECK_READER(requests,
+                 7,
+                 true,
+                 "GET /a \nPOST /b body\nPOST /c Wikipedia\nDELETE /d \n",
+                 http::parse_error::none);
+    // bodies, which are not read, are skipped by next_request
+    CHECK_READER(requests,
+                 16,
+                 false,
+                 "GET /a \nPOST /b \nPOST /c \nDELETE /d \n",
+                 http::parse_error::none);
+    CHECK_READER("POST /a HTTP/1.1\r\n"
+                 "Content-Length: 10\r\n"
+                 "\r\n"
+                 "body",
+                 4096,
+                 true,
+                 "POST /a body\n",
+                 http::parse_error::bad_request);
+    CHECK_READER("GET /a HTTP/1.1\r\n"
+                 "\r\n"
+                 "GET /b",
+                 4096,
+                 true,
+                 "GET /a \n",
+                 http::parse_error::bad_request);
+    CHECK_READER("GET /a HTTP/1.1\r\n"
+                 "Content-Length: x\r\n"
+                 "\r\n",
+                 4096,
+                 true,
+                 "",
+                 http::parse_error::bad_request);
+
+    // reader of socket is suspended until next part of request is sent
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) != 0) {
+      std::cerr << "can not create socket pair" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::string out;
+    bool        finished = false;
+    {
+      http::event_loop                           loop;
+      http::socket_stream                        stream{loop, fds[0]};
+      http::request_reader<http::socket_stream> reader{stream, 64};
+      http::spawn(read_requests(reader, true, out, finished));
+      for (size_t offset = 0; offset < strlen(requests); offset += 5) {
+        size_t size = std::min<size_t>(5, strlen(requests) - offset);
+        if (send(fds[1], requests + offset, size, 0) != (ssize_t)size ||
+            loop.poll(-1) != 1) {
+          std::cerr << "reader is not resumed by data" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      close(fds[1]);
+      while (finished == false && loop.poll(-1) >= 0) {
+      }
+      if (out != "GET /a \nPOST /b body\nPOST /c Wikipedia\nDELETE /d \n" ||
+          reader.last_error() != http::parse_error::none) {
+        std::cerr << "invalid requests from socket reader\n"
+                  << out << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    close(fds[0]);
+  }
+#endif
+
+  // check io_uring, request is received to several small provided buffers,
+  // every buffer is recycled right after parsing
+  {
+    const char *str = "GET /ring/target HTTP/1.1\r\n"
+                      "Host: example.com\r\n"
+                      "User-Agent: test\r\n"
+                      "X-Custom: some long value of custom header\r\n"
+                      "\r\n";
+    http::uring ring{8, 4, 32};
+    int         sockets[2];
+    if (ring.valid() == false) {
+      std::cerr << "io_uring is not supported, skipped" << std::endl;
+    } else if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0 ||
+               write(sockets[1], str, strlen(str)) !=
+                   static_cast<ssize_t>(strlen(str)) ||
+               ring.receive(sockets[0], 1) == false) {
+      std::cerr << "can not start receive" << std::endl;
+      return EXIT_FAILURE;
+    } else {
+      http::request_view           view;
+      http::request_parser::status status  = http::request_parser::in_complete;
+      size_t                       buffers = 0;
+      while (status == http::request_parser::in_complete &&
+             ring.submit_and_wait()) {
+        while (const io_uring_cqe *cqe = ring.peek()) {
+          std::string_view data = ring.buffer(*cqe);
+          if (data.empty() == false) {
+            status = parser.parse(data.data(), data.size(), view);
+            ++buffers;
+          }
+          ring.recycle(*cqe);
+          if ((cqe->flags & IORING_CQE_F_MORE) == 0 &&
+              status == http::request_parser::in_complete) {
+            ring.receive(sockets[0], 1);
+          }
+          ring.pop();
+        }
+      }
+      if (status != http::request_parser::done || buffers < 2 ||
+          view.target != "/ring/target" ||
+          view.header("X-Custom") != "some long value of custom header") {
+        std::cerr << "request is not parsed from provided buffers: "
+                  << buffers << std::endl;
+        return EXIT_FAILURE;
+      }
+      close(sockets[0]);
+      close(sockets[1]);
+    }
+  }
+
   return EXIT_SUCCESS;
 }